@@ -1,396 +1,2739 @@
-/*
-  
-  Detective Quest - exploração de mansão (árvore binária), coleta de pistas (BST)
-  e associação pista -> suspeito (hash). Julgamento final com verificação automática.
-  Compilar: gcc -o detective_quest detective_quest.c -std=c11
-*/
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
-
-#define MAX_NOME 64
-#define HASH_SIZE 101
-
-/* ---------- ESTRUTURAS ---------- */
-
-/* Sala na mansão (nó da árvore binária) */
-typedef struct Sala {
-    char nome[MAX_NOME];
-    struct Sala *esq;
-    struct Sala *dir;
-    struct Sala *pai; /* para permitir voltar */
-} Sala;
-
-/* Nó da BST de pistas */
-typedef struct PistaNode {
-    char *texto;                /* dinamicamente alocado */
-    struct PistaNode *esq;
-    struct PistaNode *dir;
-} PistaNode;
-
-/* Nó da tabela hash (encadeamento separado) */
-typedef struct HashNode {
-    char *pista;       /* chave */
-    char *suspeito;    /* valor */
-    struct HashNode *next;
-} HashNode;
-
-/* ---------- PROTÓTIPOS (funções exigidas e utilitárias) ---------- */
-
-/* criarSala() – cria dinamicamente um cômodo. */
-Sala* criarSala(const char *nome);
-
-/* explorarSalas() – navega pela árvore e ativa o sistema de pistas. */
-void explorarSalas(Sala *raiz, PistaNode **bstPistas, HashNode *hash[]);
-
-/* inserirPista() / adicionarPista() – insere a pista coletada na árvore BST. */
-PistaNode* inserirPista(PistaNode *root, const char *texto);
-void adicionarPista(PistaNode **root, const char *texto);
-
-/* inserirNaHash() – insere associação pista/suspeito na tabela hash. */
-unsigned int hashFunction(const char *s);
-void inserirNaHash(HashNode *hash[], const char *pista, const char *suspeito);
-
-/* encontrarSuspeito() – consulta o suspeito correspondente a uma pista. */
-const char* encontrarSuspeito(HashNode *hash[], const char *pista);
-
-/* verificarSuspeitoFinal() – conduz à fase de julgamento final. */
-void verificarSuspeitoFinal(PistaNode *root, HashNode *hash[]);
-
-/* funções utilitárias */
-const char* pistaAssociadaASala(const char *nomeSala); /* define pistas estáticas por sala */
-void listarPistasBST(PistaNode *root);
-void liberarBST(PistaNode *root);
-void liberarHash(HashNode *hash[]);
-void montarMapa(Sala **raiz); /* constrói mapa fixo no main() */
-void mostrarSalaOpcoes(Sala *atual);
-void limpaNewline(char *s);
-
-/* ---------- IMPLEMENTAÇÃO ---------- */
-
-/* cria dinamicamente uma sala com nome (criarSala) */
-Sala* criarSala(const char *nome) {
-    Sala *s = (Sala*) malloc(sizeof(Sala));
-    if (!s) {
-        perror("malloc criarSala");
-        exit(1);
-    }
-    strncpy(s->nome, nome, MAX_NOME-1);
-    s->nome[MAX_NOME-1] = '\0';
-    s->esq = s->dir = s->pai = NULL;
-    return s;
-}
-
-/* Hash simples (djb2 mod HASH_SIZE) */
-unsigned int hashFunction(const char *s) {
-    unsigned long hash = 5381;
-    int c;
-    while ((c = *s++))
-        hash = ((hash << 5) + hash) + (unsigned char)c;
-    return (unsigned int)(hash % HASH_SIZE);
-}
-
-/* inserirNaHash: insere cópia da chave e valor na tabela */
-void inserirNaHash(HashNode *hash[], const char *pista, const char *suspeito) {
-    unsigned int idx = hashFunction(pista);
-    HashNode *node = (HashNode*) malloc(sizeof(HashNode));
-    if (!node) { perror("malloc inserirNaHash"); exit(1); }
-    node->pista = strdup(pista);
-    node->suspeito = strdup(suspeito);
-    node->next = hash[idx];
-    hash[idx] = node;
-}
-
-/* encontrarSuspeito: retorna ponteiro para string do suspeito (ou NULL se não existir) */
-const char* encontrarSuspeito(HashNode *hash[], const char *pista) {
-    unsigned int idx = hashFunction(pista);
-    HashNode *cur = hash[idx];
-    while (cur) {
-        if (strcmp(cur->pista, pista) == 0) return cur->suspeito;
-        cur = cur->next;
-    }
-    return NULL;
-}
-
-/* inserirPista: insere texto unicamente numa BST (evita duplicatas) */
-PistaNode* inserirPista(PistaNode *root, const char *texto) {
-    if (!root) {
-        PistaNode *n = (PistaNode*) malloc(sizeof(PistaNode));
-        if (!n) { perror("malloc inserirPista"); exit(1); }
-        n->texto = strdup(texto);
-        n->esq = n->dir = NULL;
-        return n;
-    }
-    int cmp = strcmp(texto, root->texto);
-    if (cmp == 0) {
-        /* já existe: não duplicar */
-        return root;
-    } else if (cmp < 0) {
-        root->esq = inserirPista(root->esq, texto);
-    } else {
-        root->dir = inserirPista(root->dir, texto);
-    }
-    return root;
-}
-
-/* adicionarPista: wrapper que atualiza ponteiro raiz */
-void adicionarPista(PistaNode **root, const char *texto) {
-    *root = inserirPista(*root, texto);
-}
-
-/* pistaAssociadaASala: define as pistas estáticas para cada sala (regra codificada) */
-const char* pistaAssociadaASala(const char *nomeSala) {
-    /* exemplo: mapeamento fixo */
-    if (strcmp(nomeSala, "Entrada") == 0) return "pegada molhada";
-    if (strcmp(nomeSala, "Sala de Estar") == 0) return "cinzeiro quebrado";
-    if (strcmp(nomeSala, "Biblioteca") == 0) return "marcador de livro rasgado";
-    if (strcmp(nomeSala, "Cozinha") == 0) return "panela com restos";
-    if (strcmp(nomeSala, "Escritorio") == 0) return "bilhete amassado";
-    if (strcmp(nomeSala, "Quarto") == 0) return "fio de cabelo loiro";
-    if (strcmp(nomeSala, "Banheiro") == 0) return "detergente derramado";
-    if (strcmp(nomeSala, "Jardim") == 0) return "pegada de sola distinta";
-    if (strcmp(nomeSala, "Sotao") == 0) return "ferramenta enferrujada";
-    if (strcmp(nomeSala, "Garagem") == 0) return "marca de pneu";
-    /* salas sem pista retornam NULL */
-    return NULL;
-}
-
-/* explorarSalas: navegação interativa com coleta de pistas.
-   - Parametros: raiz atual da exploração, ponteiro para raiz da BST de pistas coletadas,
-     tabela hash (já populada com associações pista->suspeito).
-   - Navegação: 'e' esquerda, 'd' direita, 'v' voltar ao pai (usamos pai para permitir voltar),
-     's' sair. Em cada visita, exibe sala e pista (se existir) e armazena a pista na BST.
-*/
-void explorarSalas(Sala *atual, PistaNode **bstPistas, HashNode *hash[]) {
-    if (!atual) return;
-    Sala *pos = atual;
-    char buffer[64];
-    while (1) {
-        printf("\nVocê está na sala: %s\n", pos->nome);
-        const char *pista = pistaAssociadaASala(pos->nome);
-        if (pista) {
-            printf("  -> Você encontrou uma pista: \"%s\"\n", pista);
-            /* adiciona na BST (não duplica) */
-            adicionarPista(bstPistas, pista);
-        } else {
-            printf("  -> Nenhuma pista aparente nesta sala.\n");
-        }
-
-        mostrarSalaOpcoes(pos);
-        if (!fgets(buffer, sizeof(buffer), stdin)) break;
-        limpaNewline(buffer);
-        if (strlen(buffer) == 0) { printf("Opção vazia. Tente novamente.\n"); continue; }
-        char cmd = buffer[0];
-
-        if (cmd == 's') {
-            printf("Saindo da exploração.\n");
-            return;
-        } else if (cmd == 'e') {
-            if (pos->esq) {
-                pos = pos->esq;
-            } else {
-                printf("Não há sala à esquerda.\n");
-            }
-        } else if (cmd == 'd') {
-            if (pos->dir) {
-                pos = pos->dir;
-            } else {
-                printf("Não há sala à direita.\n");
-            }
-        } else if (cmd == 'v') {
-            if (pos->pai) pos = pos->pai;
-            else printf("Você está na raiz; não há sala pai.\n");
-        } else {
-            printf("Comando desconhecido. Use 'e' (esq), 'd' (dir), 'v' (voltar), 's' (sair).\n");
-        }
-    }
-}
-
-/* listarPistasBST: percorre em-ordem e mostra pistas coletadas */
-void listarPistasBST(PistaNode *root) {
-    if (!root) return;
-    listarPistasBST(root->esq);
-    printf("  - %s\n", root->texto);
-    listarPistasBST(root->dir);
-}
-
-/* verificarSuspeitoFinal: percorre a BST de pistas, consulta hash para cada pista e conta quantas apontam
-   para o suspeito acusado. Se >=2, acusação é bem-sucedida. */
-void verificarSuspeitoFinal(PistaNode *root, HashNode *hash[]) {
-    if (!root) {
-        printf("Nenhuma pista coletada. Impossível julgar.\n");
-        return;
-    }
-    char acusado[64];
-    printf("\nDigite o nome do suspeito que deseja acusar: ");
-    if (!fgets(acusado, sizeof(acusado), stdin)) return;
-    limpaNewline(acusado);
-    if (strlen(acusado) == 0) {
-        printf("Nome vazio. Acusação cancelada.\n");
-        return;
-    }
-
-    /* Percorre as pistas e conta quantas mapeiam para 'acusado' */
-    int contador = 0;
-    /* usar pilha recursiva: lambda-like auxiliar */
-    /* Implementamos uma função interna via ponteiro recursivo (definida aqui mesmo) */
-    void contarRec(PistaNode *n) {
-        if (!n) return;
-        contarRec(n->esq);
-        const char *s = encontrarSuspeito(hash, n->texto);
-        if (s && strcmp(s, acusado) == 0) {
-            contador++;
-        }
-        contarRec(n->dir);
-    }
-    contarRec(root);
-
-    printf("\nResultado da acuação contra '%s':\n", acusado);
-    if (contador >= 2) {
-        printf("  Sucesso! %d pista(s) suportam a acusação. O culpado foi preso.\n", contador);
-    } else if (contador == 1) {
-        printf("  Há apenas 1 pista apontando para '%s'. Não é suficiente para condenar.\n", acusado);
-    } else {
-        printf("  Nenhuma pista aponta para '%s'. Acusação infundada.\n", acusado);
-    }
-}
-
-/* liberarBST: liberar memória da BST de pistas */
-void liberarBST(PistaNode *root) {
-    if (!root) return;
-    liberarBST(root->esq);
-    liberarBST(root->dir);
-    free(root->texto);
-    free(root);
-}
-
-/* liberarHash: libera cada cadeia na tabela hash */
-void liberarHash(HashNode *hash[]) {
-    for (int i = 0; i < HASH_SIZE; ++i) {
-        HashNode *cur = hash[i];
-        while (cur) {
-            HashNode *next = cur->next;
-            free(cur->pista);
-            free(cur->suspeito);
-            free(cur);
-            cur = next;
-        }
-        hash[i] = NULL;
-    }
-}
-
-/* montarMapa: cria manualmente o mapa (árvore de salas) e conecta pais */
-void montarMapa(Sala **raiz) {
-    /* Exemplo de mansão fixa:
-               Entrada
-              /       \
-       Sala de Estar  Cozinha
-         /     \         \
-     Biblioteca Quarto   Garagem
-      /                /
-    Sotao           Jardim
-    (ajuste conforme desejar)
-    */
-    Sala *entrada = criarSala("Entrada");
-    Sala *estar = criarSala("Sala de Estar");
-    Sala *cozinha = criarSala("Cozinha");
-    Sala *biblioteca = criarSala("Biblioteca");
-    Sala *quarto = criarSala("Quarto");
-    Sala *garagem = criarSala("Garagem");
-    Sala *sotao = criarSala("Sotao");
-    Sala *jardim = criarSala("Jardim");
-    Sala *escritorio = criarSala("Escritorio");
-    Sala *banheiro = criarSala("Banheiro");
-
-    /* ligações */
-    entrada->esq = estar; estar->pai = entrada;
-    entrada->dir = cozinha; cozinha->pai = entrada;
-
-    estar->esq = biblioteca; biblioteca->pai = estar;
-    estar->dir = quarto; quarto->pai = estar;
-
-    biblioteca->esq = sotao; sotao->pai = biblioteca;
-    cozinha->dir = garagem; garagem->pai = cozinha;
-
-    garagem->esq = jardim; jardim->pai = garagem;
-
-    quarto->esq = escritorio; escritorio->pai = quarto;
-    quarto->dir = banheiro; banheiro->pai = quarto;
-
-    *raiz = entrada;
-}
-
-/* mostrarSalaOpcoes: mostra as opções disponíveis na exploração (inclui voltar para usabilidade) */
-void mostrarSalaOpcoes(Sala *atual) {
-    printf("\nOpções de navegação:\n");
-    if (atual->esq) printf("  e - ir para a esquerda (%s)\n", atual->esq->nome);
-    if (atual->dir) printf("  d - ir para a direita (%s)\n", atual->dir->nome);
-    if (atual->pai) printf("  v - voltar para a sala (%s)\n", atual->pai->nome);
-    printf("  s - sair da exploração\n");
-    printf("Escolha (e/d/v/s): ");
-}
-
-/* limpaNewline: remove '\n' deixado por fgets */
-void limpaNewline(char *s) {
-    if (!s) return;
-    size_t l = strlen(s);
-    if (l > 0 && s[l-1] == '\n') s[l-1] = '\0';
-}
-
-/* ---------- MAIN (montagem do hash, mapa e loop principal) ---------- */
-int main(void) {
-    /* seed aleatória para eventuais expansões (não estritamente necessária aqui) */
-    srand((unsigned) time(NULL));
-
-    /* tabela hash vazia */
-    HashNode *hash[HASH_SIZE];
-    for (int i = 0; i < HASH_SIZE; ++i) hash[i] = NULL;
-
-    /* Preenchemos a tabela hash com associações pista -> suspeito
-       (regras codificadas; pode ser ajustado). */
-    inserirNaHash(hash, "pegada molhada", "Sr. Verde");
-    inserirNaHash(hash, "cinzeiro quebrado", "Sra. Azul");
-    inserirNaHash(hash, "marcador de livro rasgado", "Prof. Roxo");
-    inserirNaHash(hash, "panela com restos", "Sra. Azul");
-    inserirNaHash(hash, "bilhete amassado", "Sr. Verde");
-    inserirNaHash(hash, "fio de cabelo loiro", "Sra. Rosa");
-    inserirNaHash(hash, "detergente derramado", "Sr. Amarelo");
-    inserirNaHash(hash, "pegada de sola distinta", "Sr. Verde");
-    inserirNaHash(hash, "ferramenta enferrujada", "Prof. Roxo");
-    inserirNaHash(hash, "marca de pneu", "Sr. Amarelo");
-    /* se desejar, mais pistas podem ser adicionadas */
-
-    /* monta mapa fixo */
-    Sala *raiz = NULL;
-    montarMapa(&raiz);
-
-    /* BST de pistas coletadas (inicialmente vazia) */
-    PistaNode *bstPistas = NULL;
-
-    /* iniciar exploração a partir da raiz */
-    printf("Bem-vindo(a) a Detective Quest - Explore a mansão e colete pistas!\n");
-    printf("Navegue pelas salas e ao terminar faremos o julgamento.\n");
-
-    explorarSalas(raiz, &bstPistas, hash);
-
-    /* Fim da exploração: listamos pistas e pedimos acusação */
-    printf("\n--- Pistas coletadas (ordenadas) ---\n");
-    if (!bstPistas) {
-        printf("Nenhuma pista coletada.\n");
-    } else {
-        listarPistasBST(bstPistas);
-    }
-
-    verificarSuspeitoFinal(bstPistas, hash);
-
-    /* liberar memória (BST e hash). Observação: salas não são liberadas aqui para simplificar;
-       em código de produção você liberaria todas as salas também. */
-    liberarBST(bstPistas);
-    liberarHash(hash);
-
-    printf("\nObrigado por jogar Detective Quest!\n");
-
-    return 0;
-}
+/*
+  
+  Detective Quest - exploração de mansão (árvore binária), coleta de pistas (BST)
+  e associação pista -> suspeito (hash). Julgamento final com verificação automática.
+  Compilar: gcc -o detective_quest detective_quest.c -std=c11 -pthread
+  Benchmark da tabela hash: ./detective_quest --bench-hash [numPistas]
+  Benchmark de sessões (arena): ./detective_quest --bench-sessoes [numSessoes]
+  Mansão de arquivo: ./detective_quest --mansao arq.mansao [--pistas arq.pistas]
+  Gerar mansão de teste: ./detective_quest --gerar-mansao numSalas arq.mansao arq.pistas [semente]
+  Regerar as tabelas de hash perfeito: ./detective_quest --gerar-phf
+  Exploração sem interação (benchmark): ./detective_quest --roteiro arq.cmd [--repetir K]
+    ou ./detective_quest --passeio numPassos, ambos aceitando --mansao/--pistas depois
+  Rotas mínimas para condenar cada suspeito: ./detective_quest --planejar 1 [--mansao ...]
+  Detetives em paralelo: ./detective_quest --detetives T [--passeio passosPorDetetive] [--mansao ...]
+  Suspender/retomar: qualquer modo aceita --salvar arq.snap (grava ao fim da exploração)
+    e --retomar arq.snap (no lugar de --mansao/--pistas)
+  Passeios reproduzíveis: --semente N (sem ela, a semente vem do relógio)
+  Busca por trecho nas pistas coletadas: --buscar "trecho" (em qualquer modo de exploração)
+  Benchmark da busca por trecho (índice de trigramas x BST): ./detective_quest --bench-trechos [numPistas]
+  Instrumentação (instr.h): compilar com -DINSTRUMENTAR; estatísticas em INSTR_SAIDA ao sair
+
+  Formato dos arquivos (uma definição por linha; linhas vazias ou com '#' são ignoradas):
+    .mansao: nome;pai;lado;pista  - pai é o índice (0-based) de uma sala anterior ou -1 na
+                                    raiz, lado é 'e' ou 'd' e pista é opcional
+    .pistas: pista;suspeito
+    .cmd:    sequência de comandos e/d/v/s (espaços e quebras de linha são ignorados)
+    .snap:   binário (ver CabecalhoSnapshot): só deslocamentos, carregado com um mmap
+*/
+
+#define _POSIX_C_SOURCE 200809L /* strdup em -std=c11 */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "instr.h"
+#include "prng.h"
+
+#define MAX_NOME 64
+#define HASH_SIZE 101
+#define TABELA_CAP_INICIAL 16 /* capacidade inicial das tabelas abertas (potência de 2) */
+#define AVL_ALTURA_MAX 64     /* altura AVL <= 1.44*log2(n+2): 64 cobre qualquer n endereçável */
+#define ARENA_BLOCO 65536     /* tamanho padrão de cada bloco da arena da sessão */
+#define SALA_NENHUMA UINT32_MAX /* índice nulo na mansão plana */
+#define FIXO_NAO_RESOLVIDO (-2) /* suspeitoFixoDe: pista ainda não consultada na tabela estática */
+#define PISTAS_PARA_CONDENAR 2  /* pistas distintas necessárias numa acusação */
+#define RANKING_RESUMO_SUSPEITOS 10 /* ranking resumido dos benchmarks: suspeitos mostrados */
+#define RANKING_RESUMO_PISTAS 3     /* ... e pistas mostradas de cada um */
+#define SNAPSHOT_VERSAO 1
+#define TRIGRAMA_VAZIO 0      /* chave de slot livre (nenhum trigrama de texto C tem byte 0) */
+
+/* resultados de passoExploracao */
+#define PASSO_MOVEU 0
+#define PASSO_SEM_SALA 1 /* não há sala na direção pedida */
+#define PASSO_SAIR 2
+#define PASSO_INVALIDO 3
+
+/* ---------- ESTRUTURAS ---------- */
+
+/* Bloco de uma arena (bump allocator); os blocos são reaproveitados após reset */
+typedef struct BlocoArena {
+    struct BlocoArena *prox;
+    size_t capacidade;
+    size_t usado;
+    max_align_t dados[]; /* área de alocação, alinhada para qualquer tipo */
+} BlocoArena;
+
+/* Arena: alocação por incremento de ponteiro e liberação em bloco */
+typedef struct {
+    BlocoArena *primeiro;
+    BlocoArena *atual;
+    size_t tamBloco;
+} Arena;
+
+/* Sala na mansão (nó da árvore binária) */
+typedef struct Sala {
+    char nome[MAX_NOME];
+    struct Sala *esq;
+    struct Sala *dir;
+    struct Sala *pai; /* para permitir voltar */
+    int pista;        /* id internado da pista da sala (-1 = nenhuma) */
+} Sala;
+
+/* Nó da mansão plana: 16 bytes, com índices de 32 bits no lugar de ponteiros e sem o
+   nome (quatro salas por linha de cache) */
+typedef struct {
+    uint32_t esq;
+    uint32_t dir;
+    uint32_t pai;
+    int32_t pista; /* id internado da pista da sala (-1 = nenhuma) */
+} NoMansao;
+
+/* Mansão plana: nós num vetor em ordem BFS (raiz no índice 0; os filhos de salas
+   vizinhas ficam vizinhos) e nomes num pool separado, fora do caminho da navegação.
+   É a forma usada na exploração; a árvore de Sala serve só para montar o mapa. */
+typedef struct {
+    NoMansao *nos;
+    uint32_t *nome; /* deslocamento do nome de cada sala em pool */
+    char *pool;
+    uint32_t tamPool;
+    uint32_t numSalas;
+} MansaoPlana;
+
+/* Tabela de internação: cada texto distinto (pista ou suspeito) é guardado uma
+   única vez e recebe um id denso (0, 1, 2, ...); depois disso, comparar textos
+   é comparar inteiros. */
+typedef struct {
+    const char **textos;     /* id -> texto (na arena) */
+    unsigned int *hashes;    /* id -> hash em cache */
+    int *slots;              /* endereçamento aberto: id ou -1 (vazio) */
+    unsigned int capSlots;   /* potência de 2 */
+    int numIds;
+    int capIds;
+    Arena *arena;
+} Internador;
+
+/* Nó da BST de pistas (árvore AVL: altura sempre logarítmica) */
+typedef struct PistaNode {
+    int id;                     /* id internado da pista (chave da árvore) */
+    struct PistaNode *esq;
+    struct PistaNode *dir;
+    int altura;                 /* altura da subárvore (folha = 1) */
+} PistaNode;
+
+/* Nó da tabela hash encadeada (mantida como referência para o benchmark) */
+typedef struct HashNode {
+    char *pista;       /* chave */
+    char *suspeito;    /* valor */
+    struct HashNode *next;
+} HashNode;
+
+/* Entrada da tabela hash com endereçamento aberto (Robin Hood).
+   Chave e valor são ids internados; o próprio id (denso) serve de hash. */
+typedef struct {
+    int pista;           /* -1 = slot vazio */
+    int suspeito;
+} EntradaHash;
+
+/* Tabela hash pista -> suspeito: sondagem linear Robin Hood, cresce automaticamente */
+typedef struct {
+    EntradaHash *slots;
+    unsigned int capacidade; /* potência de 2 */
+    unsigned int tamanho;
+    Arena *arena;            /* origem dos slots */
+    Internador *nomes;       /* textos de pistas e suspeitos */
+} TabelaHash;
+
+/* Item da lista de pistas de um suspeito (índice invertido suspeito -> pistas) */
+typedef struct ItemIndice {
+    int pista;
+    struct ItemIndice *prox;
+} ItemIndice;
+
+/* Índice de suspeitos mantido a cada pista nova: contagem e lista de pistas por
+   suspeito, e a ordem dos suspeitos por contagem (decrescente) mantida em O(1)
+   por pista, de modo que acusação e ranking não percorrem a BST. */
+typedef struct {
+    int *contagem;           /* id do suspeito -> nº de pistas coletadas contra ele */
+    ItemIndice **listas;     /* id do suspeito -> pistas coletadas contra ele */
+    int *posicao;            /* id do suspeito -> posição em ordem[] (-1 se ausente) */
+    int capIds;
+    int *ordem;              /* suspeitos com contagem >= 1, em ordem decrescente */
+    int numSuspeitos;
+    int *inicioFaixa;        /* contagem c -> primeira posição de ordem[] com contagem c */
+    int *quantosComContagem; /* contagem c -> nº de suspeitos com contagem c */
+    int capContagens;
+    Arena *arena;
+} IndiceSuspeitos;
+
+/* Lista de ocorrências de um trigrama: números de coleta (posições em
+   IndiceTrigramas.pistas) das pistas que o contêm, crescentes por construção */
+typedef struct {
+    uint32_t chave;          /* os 3 bytes do trigrama (TRIGRAMA_VAZIO = slot livre) */
+    int tam;
+    int cap;
+    int *itens;
+} ListaTrigrama;
+
+/* Índice invertido trigrama -> pistas coletadas, atualizado em adicionarPista: uma
+   busca por trecho intersecta as listas dos trigramas do trecho (da menor para a maior)
+   e só confere com strstr as pistas que sobram. */
+typedef struct {
+    int *pistas;             /* número de coleta -> id da pista */
+    int numPistas;
+    int capPistas;
+    ListaTrigrama *listas;   /* endereçamento aberto pela chave do trigrama */
+    unsigned int capListas;  /* potência de 2 */
+    unsigned int numListas;
+    Arena *arena;
+} IndiceTrigramas;
+
+/* Sessão de investigação: mapa, textos, hash e pistas vivem na arena da sessão e
+   são descartados juntos por resetarSessao()/encerrarSessao(). */
+typedef struct {
+    Arena arena;
+    Internador nomes;   /* textos de pistas e suspeitos, cada um guardado uma vez */
+    TabelaHash hash;    /* pista -> suspeito */
+    PistaNode *pistas;  /* BST de pistas coletadas */
+    IndiceSuspeitos indice; /* suspeito -> pistas coletadas, atualizado em adicionarPista */
+    IndiceTrigramas trigramas; /* trigrama -> pistas coletadas, idem (busca por trecho) */
+    Sala *mapa;         /* raiz da mansão (árvore usada na montagem) */
+    MansaoPlana plana;  /* a mesma mansão achatada, usada na exploração */
+    void *snapshot;     /* mapeamento de um snapshot retomado (ou NULL) */
+    size_t tamSnapshot;
+    int *suspeitoFixoDe; /* id de pista -> suspeito da tabela estática, preenchido na primeira
+                            falta da hash dinâmica (FIXO_NAO_RESOLVIDO = ainda não consultado) */
+    int numFixoDe;       /* ids de pista cobertos por suspeitoFixoDe */
+} Sessao;
+
+/* Contadores de uma exploração roteirizada (sem interação) */
+typedef struct {
+    long passos;          /* comandos consumidos, inclusive os bloqueados */
+    long movimentos;      /* passos que mudaram de sala */
+    long visitasComPista; /* visitas a salas com pista (cada uma consulta a BST) */
+    long pistasNovas;     /* pistas que entraram na BST pela primeira vez */
+    double segundos;
+} ResultadoRoteiro;
+
+/* Rota mínima a partir da Entrada para reunir PISTAS_PARA_CONDENAR pistas contra um suspeito */
+typedef struct {
+    int suspeito;      /* id internado */
+    long movimentos;   /* -1 se a mansão não tem pistas distintas suficientes */
+    uint32_t salas[2]; /* salas com pista, na ordem da visita */
+    char *comandos;    /* roteiro e/d/v terminado em '\0' (NULL se impossível) */
+} RotaSuspeito;
+
+/* Detetive de uma exploração paralela. Durante o passeio só lê a mansão e o mapa
+   pista -> suspeito congelado; as pistas vão para um bitmap próprio (por id, portanto
+   já ordenado), fundido na sessão quando todas as threads terminam. */
+typedef struct {
+    const MansaoPlana *mansao;
+    const int *suspeitoDe; /* suspeito de cada id de pista (-1 = nenhum), somente leitura */
+    int numIds;
+    long passos;
+    Prng aleatorio;        /* fluxo próprio (saltado a partir do gerador global) */
+    uint64_t *pistas;      /* bitmap local de pistas coletadas */
+    long visitasComPista;
+    long pistasNovas;
+    int melhorSuspeito;    /* suspeito com mais pistas coletadas por este detetive */
+    int melhorContagem;
+    pthread_t thread;
+} Detetive;
+
+/* Cabeçalho do snapshot (.snap). Cada seção começa num deslocamento múltiplo de 8 a
+   partir do início do arquivo e é usada no lugar, direto do mapeamento:
+     nos[numSalas] (NoMansao), nomeSala[numSalas], poolSalas[tamPoolSalas],
+     textoOff[numIds], textoHash[numIds], slotsNomes[capSlotsNomes], poolTextos[tamPoolTextos],
+     hash[capHash] (EntradaHash), coletadas[numColetadas] (ids em ordem crescente).
+   Inteiros na ordem de bytes da máquina que gravou (conferida por 'ordem'). */
+typedef struct {
+    char magica[8];          /* "DQSNAP" */
+    uint32_t versao;
+    uint32_t ordem;          /* 0x01020304 */
+    uint32_t numSalas, tamPoolSalas;
+    uint32_t numIds, capSlotsNomes, tamPoolTextos;
+    uint32_t capHash, tamHash;
+    uint32_t numColetadas;
+    uint64_t offNos, offNomeSala, offPoolSalas;
+    uint64_t offTextoOff, offTextoHash, offSlotsNomes, offPoolTextos;
+    uint64_t offHash, offColetadas;
+    uint64_t tamArquivo;
+} CabecalhoSnapshot;
+
+/* Par chave -> valor das tabelas estáticas (definidas em tempo de compilação) */
+typedef struct {
+    const char *chave;
+    const char *valor;
+} ParFixo;
+
+/* ---------- PROTÓTIPOS (funções exigidas e utilitárias) ---------- */
+
+/* arena da sessão */
+void arenaInicializar(Arena *a, size_t tamBloco);
+void* arenaAlocar(Arena *a, size_t tam);
+char* arenaCopiarTexto(Arena *a, const char *s);
+void arenaResetar(Arena *a);
+void arenaLiberar(Arena *a);
+
+/* sessão: cria, reaproveita (reset) e encerra */
+void iniciarSessao(Sessao *s);
+void resetarSessao(Sessao *s);
+void encerrarSessao(Sessao *s);
+
+/* criarSala() – cria dinamicamente um cômodo. */
+Sala* criarSala(Arena *a, const char *nome);
+
+/* mansão plana: achatada a partir de sessao->mapa ao fim de montarMapa/carregarMansao */
+void achatarMansao(Sessao *sessao);
+const char* nomeDaSala(const MansaoPlana *m, uint32_t sala);
+
+/* explorarSalas() – navega pela árvore e ativa o sistema de pistas. */
+void explorarSalas(Sessao *sessao);
+
+/* exploração sem E/S: passo a passo, por roteiro de comandos ou passeio aleatório */
+int passoExploracao(const MansaoPlana *m, uint32_t *pos, char cmd);
+void explorarRoteiro(Sessao *sessao, const char *cmds, size_t n, ResultadoRoteiro *r);
+char* gerarPasseio(const MansaoPlana *m, long numPassos);
+void mostrarResultadoRoteiro(const ResultadoRoteiro *r, const Sessao *sessao);
+
+/* planejador de rotas: programação dinâmica na árvore (mansão plana) */
+int planejarRotas(Sessao *sessao, RotaSuspeito **rotas);
+void liberarRotas(RotaSuspeito *rotas, int n);
+void mostrarRotas(const RotaSuspeito *rotas, int n, const Internador *nomes);
+
+/* detetives em paralelo sobre a mesma mansão */
+int* congelarSuspeitos(Sessao *sessao);
+double explorarEmParalelo(Sessao *sessao, const int *suspeitoDe, Detetive d[], int numDetetives, long passos);
+void benchmarkDetetives(Sessao *sessao, int maxDetetives, long passos);
+
+/* inserirPista() / adicionarPista() – insere a pista coletada na árvore BST. */
+PistaNode* inserirPista(Arena *a, PistaNode *root, int id, int *inserida);
+void adicionarPista(Sessao *sessao, const char *texto);
+int adicionarPistaId(Sessao *sessao, int id);
+
+/* internação de textos: texto <-> id denso */
+void inicializarInternador(Internador *in, Arena *a);
+int internar(Internador *in, const char *s);
+int procurarId(const Internador *in, const char *s);
+const char* textoDoId(const Internador *in, int id);
+
+/* inserirNaHash() – insere associação pista/suspeito na tabela hash. */
+unsigned int hashFunction(const char *s);
+unsigned int hashCompleto(const char *s, unsigned int *tam);
+void inicializarTabela(TabelaHash *t, Arena *a, Internador *nomes);
+void inserirNaHash(TabelaHash *t, const char *pista, const char *suspeito);
+void inserirNaHashIds(TabelaHash *t, int pista, int suspeito);
+
+/* encontrarSuspeito() – consulta o suspeito correspondente a uma pista. */
+const char* encontrarSuspeito(const TabelaHash *t, const char *pista);
+int encontrarSuspeitoId(const TabelaHash *t, int pista);
+
+/* verificarSuspeitoFinal() – conduz à fase de julgamento final. */
+void verificarSuspeitoFinal(Sessao *sessao);
+
+/* índice incremental de suspeitos (acusação e ranking em O(1) por consulta) */
+void inicializarIndice(IndiceSuspeitos *idx, Arena *a);
+void registrarPistaNoIndice(IndiceSuspeitos *idx, int suspeito, int pista);
+int contarPistasContra(const IndiceSuspeitos *idx, int suspeito);
+int rankingSuspeitos(const IndiceSuspeitos *idx, const int **ordem);
+void mostrarRanking(const IndiceSuspeitos *idx, const Internador *nomes, int maxSuspeitos, int maxPistas);
+
+/* índice de trigramas das pistas coletadas (busca por trecho) */
+void inicializarTrigramas(IndiceTrigramas *idx, Arena *a);
+void registrarPistaNosTrigramas(IndiceTrigramas *idx, int pista, const char *texto);
+int buscarPistasPorTrecho(const Sessao *sessao, const char *trecho, int **ids);
+void mostrarBuscaPorTrecho(const Sessao *sessao, const char *trecho);
+void benchmarkTrechos(int numPistas);
+
+/* versão encadeada original (HASH_SIZE baldes), usada como referência no benchmark */
+void inserirNaHashEncadeada(HashNode *hash[], const char *pista, const char *suspeito);
+const char* encontrarSuspeitoEncadeado(HashNode *hash[], const char *pista);
+void liberarHashEncadeada(HashNode *hash[]);
+void benchmarkHash(int numPistas);
+void benchmarkSessoes(int numSessoes);
+
+/* tabelas estáticas com hash perfeito mínimo (geradas por --gerar-phf) */
+const char* suspeitoFixo(const char *pista);
+int suspeitoDaPista(Sessao *sessao, int pista);
+void gerarTabelasPerfeitas(void);
+
+/* funções utilitárias */
+const char* pistaAssociadaASala(const char *nomeSala); /* define pistas estáticas por sala */
+void listarPistasBST(PistaNode *root, const Internador *nomes);
+void montarMapa(Sessao *sessao); /* constrói mapa fixo no main() */
+char* lerArquivo(const char *caminho, size_t *tam);
+Sala* carregarMansao(Sessao *sessao, const char *caminho, int *numSalas);
+int carregarPistas(Sessao *sessao, const char *caminho);
+int gerarMansao(int numSalas, const char *arqMansao, const char *arqPistas);
+
+/* snapshot binário: suspender e retomar a investigação */
+int salvarSnapshot(const Sessao *sessao, const char *caminho);
+int carregarSnapshot(Sessao *sessao, const char *caminho);
+PistaNode* construirPistasOrdenadas(Arena *a, const int ids[], int n);
+void mostrarSalaOpcoes(const MansaoPlana *m, uint32_t atual);
+void limpaNewline(char *s);
+
+/* ---------- DADOS ESTÁTICOS ---------- */
+
+/* Associações pista -> suspeito fixas (regras codificadas; pode ser ajustado).
+   Ao alterar PISTAS_FIXAS ou SALAS_FIXAS, rode --gerar-phf e substitua o bloco gerado. */
+static const ParFixo PISTAS_FIXAS[] = {
+    { "pegada molhada", "Sr. Verde" },
+    { "cinzeiro quebrado", "Sra. Azul" },
+    { "marcador de livro rasgado", "Prof. Roxo" },
+    { "panela com restos", "Sra. Azul" },
+    { "bilhete amassado", "Sr. Verde" },
+    { "fio de cabelo loiro", "Sra. Rosa" },
+    { "detergente derramado", "Sr. Amarelo" },
+    { "pegada de sola distinta", "Sr. Verde" },
+    { "ferramenta enferrujada", "Prof. Roxo" },
+    { "marca de pneu", "Sr. Amarelo" },
+};
+
+/* Pista estática de cada sala do mapa fixo */
+static const ParFixo SALAS_FIXAS[] = {
+    { "Entrada", "pegada molhada" },
+    { "Sala de Estar", "cinzeiro quebrado" },
+    { "Biblioteca", "marcador de livro rasgado" },
+    { "Cozinha", "panela com restos" },
+    { "Escritorio", "bilhete amassado" },
+    { "Quarto", "fio de cabelo loiro" },
+    { "Banheiro", "detergente derramado" },
+    { "Jardim", "pegada de sola distinta" },
+    { "Sotao", "ferramenta enferrujada" },
+    { "Garagem", "marca de pneu" },
+};
+
+/* --- início do bloco gerado por ./detective_quest --gerar-phf (não editar) --- */
+#define PHF_PISTAS_N 10
+#define PHF_PISTAS_BALDES 6
+static const unsigned short PHF_PISTAS_DESLOC[PHF_PISTAS_BALDES] = { 4, 0, 2, 0, 0, 9 };
+static const unsigned char PHF_PISTAS_ORDEM[PHF_PISTAS_N] = { 9, 8, 7, 0, 5, 1, 3, 2, 6, 4 };
+#define PHF_SALAS_N 10
+#define PHF_SALAS_BALDES 6
+static const unsigned short PHF_SALAS_DESLOC[PHF_SALAS_BALDES] = { 0, 0, 6, 8, 18, 1 };
+static const unsigned char PHF_SALAS_ORDEM[PHF_SALAS_N] = { 9, 3, 8, 2, 0, 6, 4, 7, 1, 5 };
+/* --- fim do bloco gerado --- */
+
+/* gerador global (prng.h): semeado em main a partir do relógio ou de --semente */
+static Prng aleatorio;
+_Static_assert(sizeof(PISTAS_FIXAS) / sizeof(PISTAS_FIXAS[0]) == PHF_PISTAS_N, "rode --gerar-phf");
+_Static_assert(sizeof(SALAS_FIXAS) / sizeof(SALAS_FIXAS[0]) == PHF_SALAS_N, "rode --gerar-phf");
+
+/* ---------- IMPLEMENTAÇÃO ---------- */
+
+/* arenaInicializar: arena vazia; o primeiro bloco é alocado sob demanda */
+void arenaInicializar(Arena *a, size_t tamBloco) {
+    a->primeiro = a->atual = NULL;
+    a->tamBloco = tamBloco;
+}
+
+/* arenaAlocar: reserva tam bytes alinhados no bloco atual. Quando o bloco enche,
+   reaproveita o próximo bloco retido (de sessões anteriores) ou aloca um novo. */
+void* arenaAlocar(Arena *a, size_t tam) {
+    const size_t alinhamento = _Alignof(max_align_t);
+    tam = (tam + alinhamento - 1) & ~(alinhamento - 1);
+    BlocoArena *b = a->atual;
+    while (b && b->capacidade - b->usado < tam && b->prox) {
+        b = b->prox;
+        b->usado = 0;
+    }
+    if (!b || b->capacidade - b->usado < tam) {
+        size_t cap = tam > a->tamBloco ? tam : a->tamBloco;
+        BlocoArena *novo = (BlocoArena*) malloc(sizeof(BlocoArena) + cap);
+        if (!novo) { perror("malloc arenaAlocar"); exit(1); }
+        novo->capacidade = cap;
+        novo->usado = 0;
+        novo->prox = b ? b->prox : NULL;
+        if (b) b->prox = novo;
+        else a->primeiro = novo;
+        b = novo;
+    }
+    a->atual = b;
+    void *p = (unsigned char*) b->dados + b->usado;
+    b->usado += tam;
+    return p;
+}
+
+/* arenaCopiarTexto: equivalente a strdup, dentro da arena */
+char* arenaCopiarTexto(Arena *a, const char *s) {
+    size_t tam = strlen(s) + 1;
+    char *p = (char*) arenaAlocar(a, tam);
+    memcpy(p, s, tam);
+    return p;
+}
+
+/* arenaResetar: descarta tudo de uma vez, mantendo os blocos para a próxima sessão */
+void arenaResetar(Arena *a) {
+    a->atual = a->primeiro;
+    if (a->atual) a->atual->usado = 0;
+}
+
+/* arenaLiberar: devolve todos os blocos ao sistema */
+void arenaLiberar(Arena *a) {
+    BlocoArena *b = a->primeiro;
+    while (b) {
+        BlocoArena *prox = b->prox;
+        free(b);
+        b = prox;
+    }
+    a->primeiro = a->atual = NULL;
+}
+
+/* iniciarSessao: arena nova, hash vazia, nenhuma pista e nenhum mapa */
+void iniciarSessao(Sessao *s) {
+    s->snapshot = NULL;
+    s->tamSnapshot = 0;
+    arenaInicializar(&s->arena, ARENA_BLOCO);
+    inicializarInternador(&s->nomes, &s->arena);
+    inicializarTabela(&s->hash, &s->arena, &s->nomes);
+    inicializarIndice(&s->indice, &s->arena);
+    inicializarTrigramas(&s->trigramas, &s->arena);
+    s->pistas = NULL;
+    s->mapa = NULL;
+    s->plana = (MansaoPlana) { NULL, NULL, NULL, 0, 0 };
+    s->suspeitoFixoDe = NULL;
+    s->numFixoDe = 0;
+}
+
+/* soltarSnapshot: desfaz o mapeamento de um snapshot retomado, se houver */
+static void soltarSnapshot(Sessao *s) {
+    if (s->snapshot) munmap(s->snapshot, s->tamSnapshot);
+    s->snapshot = NULL;
+    s->tamSnapshot = 0;
+}
+
+/* resetarSessao: descarta salas, pistas e hash, reaproveitando a memória da arena */
+void resetarSessao(Sessao *s) {
+    soltarSnapshot(s);
+    arenaResetar(&s->arena);
+    inicializarInternador(&s->nomes, &s->arena);
+    inicializarTabela(&s->hash, &s->arena, &s->nomes);
+    inicializarIndice(&s->indice, &s->arena);
+    inicializarTrigramas(&s->trigramas, &s->arena);
+    s->pistas = NULL;
+    s->mapa = NULL;
+    s->plana = (MansaoPlana) { NULL, NULL, NULL, 0, 0 };
+    s->suspeitoFixoDe = NULL;
+    s->numFixoDe = 0;
+}
+
+/* encerrarSessao: libera toda a memória da sessão (inclusive as salas) */
+void encerrarSessao(Sessao *s) {
+    soltarSnapshot(s);
+    arenaLiberar(&s->arena);
+    inicializarInternador(&s->nomes, NULL);
+    inicializarTabela(&s->hash, NULL, NULL);
+    inicializarIndice(&s->indice, NULL);
+    inicializarTrigramas(&s->trigramas, NULL);
+    s->pistas = NULL;
+    s->mapa = NULL;
+    s->plana = (MansaoPlana) { NULL, NULL, NULL, 0, 0 };
+    s->suspeitoFixoDe = NULL;
+    s->numFixoDe = 0;
+}
+
+/* cria uma sala com nome na arena da sessão (criarSala) */
+Sala* criarSala(Arena *a, const char *nome) {
+    Sala *s = (Sala*) arenaAlocar(a, sizeof(Sala));
+    strncpy(s->nome, nome, MAX_NOME-1);
+    s->nome[MAX_NOME-1] = '\0';
+    s->esq = s->dir = s->pai = NULL;
+    s->pista = -1;
+    return s;
+}
+
+/* achatarMansao: copia a árvore sessao->mapa para sessao->plana em ordem BFS. A fila da
+   BFS é o próprio vetor de saída (sem recursão, seguro em mansões profundas): o filho
+   recebe como índice a posição em que entra na fila. */
+void achatarMansao(Sessao *sessao) {
+    MansaoPlana *m = &sessao->plana;
+    *m = (MansaoPlana) { NULL, NULL, NULL, 0, 0 };
+    if (!sessao->mapa) return;
+
+    /* 1ª passada: ordem BFS e tamanho do pool de nomes */
+    size_t cap = 1024, n = 0, fila = 0, tamPool = 0;
+    Sala **ordem = (Sala**) malloc(cap * sizeof(Sala*));
+    if (!ordem) { perror("malloc achatarMansao"); exit(1); }
+    ordem[n++] = sessao->mapa;
+    while (fila < n) {
+        Sala *sala = ordem[fila++];
+        tamPool += strlen(sala->nome) + 1;
+        if (n + 2 > cap) {
+            cap *= 2;
+            Sala **novo = (Sala**) realloc(ordem, cap * sizeof(Sala*));
+            if (!novo) { perror("realloc achatarMansao"); exit(1); }
+            ordem = novo;
+        }
+        if (sala->esq) ordem[n++] = sala->esq;
+        if (sala->dir) ordem[n++] = sala->dir;
+    }
+    if (n >= SALA_NENHUMA || tamPool > UINT32_MAX) {
+        fprintf(stderr, "achatarMansao: mansao grande demais (%zu salas)\n", n);
+        exit(1);
+    }
+
+    /* 2ª passada: os filhos recebem índices na mesma ordem em que entraram na fila */
+    m->nos = (NoMansao*) arenaAlocar(&sessao->arena, n * sizeof(NoMansao));
+    m->nome = (uint32_t*) arenaAlocar(&sessao->arena, n * sizeof(uint32_t));
+    m->pool = (char*) arenaAlocar(&sessao->arena, tamPool);
+    m->tamPool = (uint32_t) tamPool;
+    m->numSalas = (uint32_t) n;
+    m->nos[0].pai = SALA_NENHUMA;
+    uint32_t prox = 1, usado = 0;
+    for (uint32_t i = 0; i < m->numSalas; ++i) {
+        const Sala *sala = ordem[i];
+        NoMansao *no = &m->nos[i];
+        no->pista = sala->pista;
+        no->esq = no->dir = SALA_NENHUMA;
+        if (sala->esq) { no->esq = prox; m->nos[prox++].pai = i; }
+        if (sala->dir) { no->dir = prox; m->nos[prox++].pai = i; }
+        size_t l = strlen(sala->nome) + 1;
+        memcpy(m->pool + usado, sala->nome, l);
+        m->nome[i] = usado;
+        usado += (uint32_t) l;
+    }
+    free(ordem);
+}
+
+/* nomeDaSala: nome de uma sala da mansão plana (no pool de nomes) */
+const char* nomeDaSala(const MansaoPlana *m, uint32_t sala) {
+    return m->pool + m->nome[sala];
+}
+
+/* Hash simples (djb2 mod HASH_SIZE) */
+unsigned int hashFunction(const char *s) {
+    unsigned long hash = 5381;
+    int c;
+    while ((c = *s++))
+        hash = ((hash << 5) + hash) + (unsigned char)c;
+    return (unsigned int)(hash % HASH_SIZE);
+}
+
+/* inserirNaHashEncadeada: insere cópia da chave e valor na tabela encadeada */
+void inserirNaHashEncadeada(HashNode *hash[], const char *pista, const char *suspeito) {
+    unsigned int idx = hashFunction(pista);
+    HashNode *node = (HashNode*) malloc(sizeof(HashNode));
+    if (!node) { perror("malloc inserirNaHash"); exit(1); }
+    node->pista = strdup(pista);
+    node->suspeito = strdup(suspeito);
+    node->next = hash[idx];
+    hash[idx] = node;
+}
+
+/* encontrarSuspeitoEncadeado: retorna ponteiro para string do suspeito (ou NULL se não existir) */
+const char* encontrarSuspeitoEncadeado(HashNode *hash[], const char *pista) {
+    unsigned int idx = hashFunction(pista);
+    HashNode *cur = hash[idx];
+    while (cur) {
+        if (strcmp(cur->pista, pista) == 0) return cur->suspeito;
+        cur = cur->next;
+    }
+    return NULL;
+}
+
+/* hashCompleto: djb2 de 32 bits com mistura final (os bits baixos indexam a tabela aberta).
+   Devolve também o comprimento da string em *tam. */
+unsigned int hashCompleto(const char *s, unsigned int *tam) {
+    unsigned int hash = 5381;
+    const unsigned char *p = (const unsigned char*) s;
+    while (*p)
+        hash = ((hash << 5) + hash) + *p++;
+    *tam = (unsigned int)(p - (const unsigned char*) s);
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bu;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/* hashPerfeito: FNV-1a de 64 bits; a metade baixa escolhe o balde e a alta, misturada
+   ao deslocamento do balde, escolhe o slot (a chave é percorrida uma única vez) */
+static uint64_t hashPerfeito(const char *s) {
+    uint64_t h = 14695981039346656037ull;
+    while (*s) {
+        h ^= (unsigned char) *s++;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static unsigned int slotPerfeito(uint64_t h, unsigned int desloc, unsigned int n) {
+    unsigned int x = (unsigned int)(h >> 32) ^ (desloc * 0x9E3779B1u);
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    return x % n;
+}
+
+/* buscaPerfeita: índice da chave em dados[] com uma sondagem e uma comparação, ou -1 */
+static int buscaPerfeita(const ParFixo dados[], const unsigned short desloc[], const unsigned char ordem[],
+                         unsigned int n, unsigned int baldes, const char *chave) {
+    uint64_t h = hashPerfeito(chave);
+    int i = ordem[slotPerfeito(h, desloc[(unsigned int) h % baldes], n)];
+    return strcmp(dados[i].chave, chave) == 0 ? i : -1;
+}
+
+/* suspeitoFixo: suspeito da tabela estática para a pista, ou NULL */
+const char* suspeitoFixo(const char *pista) {
+    int i = buscaPerfeita(PISTAS_FIXAS, PHF_PISTAS_DESLOC, PHF_PISTAS_ORDEM,
+                          PHF_PISTAS_N, PHF_PISTAS_BALDES, pista);
+    return i < 0 ? NULL : PISTAS_FIXAS[i].valor;
+}
+
+/* emitirTabelaPerfeita: procura, balde a balde (maiores primeiro), o menor deslocamento
+   que leva todas as chaves do balde a slots livres e distintos; imprime o código C */
+static void emitirTabelaPerfeita(const char *prefixo, const ParFixo dados[], unsigned int n) {
+    unsigned int baldes = n / 2 + 1;
+    unsigned short desloc[256];
+    int ordem[256];
+    unsigned int balde[256];
+    unsigned int porTamanho[256];
+    if (n > 255) { fprintf(stderr, "%s: tabela estatica grande demais\n", prefixo); exit(1); }
+
+    for (unsigned int i = 0; i < n; ++i) {
+        balde[i] = (unsigned int) hashPerfeito(dados[i].chave) % baldes;
+        ordem[i] = -1;
+    }
+    unsigned int tamanhos[256] = { 0 };
+    for (unsigned int i = 0; i < n; ++i) tamanhos[balde[i]]++;
+    for (unsigned int b = 0; b < baldes; ++b) { porTamanho[b] = b; desloc[b] = 0; }
+    for (unsigned int a = 1; a < baldes; ++a) {
+        unsigned int b = porTamanho[a], j = a;
+        while (j > 0 && tamanhos[porTamanho[j-1]] < tamanhos[b]) { porTamanho[j] = porTamanho[j-1]; j--; }
+        porTamanho[j] = b;
+    }
+
+    for (unsigned int k = 0; k < baldes; ++k) {
+        unsigned int b = porTamanho[k];
+        if (tamanhos[b] == 0) break;
+        unsigned int d;
+        for (d = 0; d < 65536; ++d) {
+            unsigned int usados[256];
+            unsigned int m = 0;
+            int ok = 1;
+            for (unsigned int i = 0; i < n && ok; ++i) {
+                if (balde[i] != b) continue;
+                unsigned int slot = slotPerfeito(hashPerfeito(dados[i].chave), d, n);
+                if (ordem[slot] >= 0) ok = 0;
+                for (unsigned int u = 0; u < m && ok; ++u) if (usados[u] == slot) ok = 0;
+                usados[m++] = slot;
+            }
+            if (ok) break;
+        }
+        if (d == 65536) { fprintf(stderr, "%s: deslocamento nao encontrado\n", prefixo); exit(1); }
+        desloc[b] = (unsigned short) d;
+        for (unsigned int i = 0; i < n; ++i)
+            if (balde[i] == b) ordem[slotPerfeito(hashPerfeito(dados[i].chave), d, n)] = (int) i;
+    }
+
+    printf("#define PHF_%s_N %u\n", prefixo, n);
+    printf("#define PHF_%s_BALDES %u\n", prefixo, baldes);
+    printf("static const unsigned short PHF_%s_DESLOC[PHF_%s_BALDES] = {", prefixo, prefixo);
+    for (unsigned int b = 0; b < baldes; ++b) printf("%s%u", b ? ", " : " ", desloc[b]);
+    printf(" };\n");
+    printf("static const unsigned char PHF_%s_ORDEM[PHF_%s_N] = {", prefixo, prefixo);
+    for (unsigned int i = 0; i < n; ++i) printf("%s%d", i ? ", " : " ", ordem[i]);
+    printf(" };\n");
+}
+
+/* conferirTabelasPerfeitas: toda chave das tabelas estáticas deve achar o próprio índice.
+   Os _Static_assert só pegam mudança de tamanho; um texto editado sem rodar --gerar-phf
+   faria buscaPerfeita devolver -1 e a pista sumiria em silêncio. Retorna quantas falham. */
+static int conferirTabelasPerfeitas(void) {
+    int falhas = 0;
+    for (int i = 0; i < PHF_PISTAS_N; ++i)
+        if (buscaPerfeita(PISTAS_FIXAS, PHF_PISTAS_DESLOC, PHF_PISTAS_ORDEM, PHF_PISTAS_N,
+                          PHF_PISTAS_BALDES, PISTAS_FIXAS[i].chave) != i) {
+            fprintf(stderr, "PISTAS_FIXAS: \"%s\" fora do hash perfeito\n", PISTAS_FIXAS[i].chave);
+            falhas++;
+        }
+    for (int i = 0; i < PHF_SALAS_N; ++i)
+        if (buscaPerfeita(SALAS_FIXAS, PHF_SALAS_DESLOC, PHF_SALAS_ORDEM, PHF_SALAS_N,
+                          PHF_SALAS_BALDES, SALAS_FIXAS[i].chave) != i) {
+            fprintf(stderr, "SALAS_FIXAS: \"%s\" fora do hash perfeito\n", SALAS_FIXAS[i].chave);
+            falhas++;
+        }
+    return falhas;
+}
+
+/* gerarTabelasPerfeitas: imprime o bloco gerado que acompanha PISTAS_FIXAS e SALAS_FIXAS */
+void gerarTabelasPerfeitas(void) {
+    printf("/* --- início do bloco gerado por ./detective_quest --gerar-phf (não editar) --- */\n");
+    emitirTabelaPerfeita("PISTAS", PISTAS_FIXAS, sizeof(PISTAS_FIXAS) / sizeof(PISTAS_FIXAS[0]));
+    emitirTabelaPerfeita("SALAS", SALAS_FIXAS, sizeof(SALAS_FIXAS) / sizeof(SALAS_FIXAS[0]));
+    printf("/* --- fim do bloco gerado --- */\n");
+}
+
+/* inicializarInternador: sem textos; vetores alocados na arena a sob demanda */
+void inicializarInternador(Internador *in, Arena *a) {
+    in->textos = NULL;
+    in->hashes = NULL;
+    in->slots = NULL;
+    in->capSlots = 0;
+    in->numIds = in->capIds = 0;
+    in->arena = a;
+}
+
+/* slot do texto s (com hash h) na tabela de ids: o que contém seu id ou o vazio onde entraria */
+static unsigned int slotInternado(const Internador *in, const char *s, unsigned int h) {
+    unsigned int mascara = in->capSlots - 1;
+    unsigned int i = h & mascara;
+    while (in->slots[i] >= 0) {
+        int id = in->slots[i];
+        if (in->hashes[id] == h && strcmp(in->textos[id], s) == 0) break;
+        i = (i + 1) & mascara;
+    }
+    return i;
+}
+
+/* procurarId: id do texto s, ou -1 se ele nunca foi internado */
+int procurarId(const Internador *in, const char *s) {
+    if (in->numIds == 0) return -1;
+    unsigned int tam;
+    unsigned int h = hashCompleto(s, &tam);
+    return in->slots[slotInternado(in, s, h)];
+}
+
+/* internar: devolve o id de s, copiando o texto para a arena na primeira vez */
+int internar(Internador *in, const char *s) {
+    unsigned int tam;
+    unsigned int h = hashCompleto(s, &tam);
+    if (in->numIds > 0) {
+        int id = in->slots[slotInternado(in, s, h)];
+        if (id >= 0) return id;
+    }
+
+    if (in->numIds == in->capIds) {
+        /* vetores id -> texto/hash dobram; os antigos ficam na arena */
+        int novaCap = in->capIds ? in->capIds * 2 : TABELA_CAP_INICIAL;
+        const char **textos = (const char**) arenaAlocar(in->arena, novaCap * sizeof(char*));
+        unsigned int *hashes = (unsigned int*) arenaAlocar(in->arena, novaCap * sizeof(unsigned int));
+        if (in->numIds > 0) {
+            memcpy(textos, in->textos, in->numIds * sizeof(char*));
+            memcpy(hashes, in->hashes, in->numIds * sizeof(unsigned int));
+        }
+        in->textos = textos;
+        in->hashes = hashes;
+        in->capIds = novaCap;
+    }
+    if ((unsigned int)(in->numIds + 1) * 2 > in->capSlots) {
+        /* mantém carga <= 1/2 na tabela de ids, reinserindo pelo hash em cache */
+        in->capSlots = in->capSlots ? in->capSlots * 2 : TABELA_CAP_INICIAL;
+        in->slots = (int*) arenaAlocar(in->arena, in->capSlots * sizeof(int));
+        memset(in->slots, 0xff, in->capSlots * sizeof(int));
+        unsigned int mascara = in->capSlots - 1;
+        for (int id = 0; id < in->numIds; ++id) {
+            unsigned int i = in->hashes[id] & mascara;
+            while (in->slots[i] >= 0) i = (i + 1) & mascara;
+            in->slots[i] = id;
+        }
+    }
+
+    int id = in->numIds++;
+    char *copia = (char*) arenaAlocar(in->arena, tam + 1);
+    memcpy(copia, s, tam + 1);
+    in->textos[id] = copia;
+    in->hashes[id] = h;
+    in->slots[slotInternado(in, s, h)] = id;
+    return id;
+}
+
+/* textoDoId: texto original de um id internado */
+const char* textoDoId(const Internador *in, int id) {
+    return (id >= 0 && id < in->numIds) ? in->textos[id] : NULL;
+}
+
+/* inicializarTabela: tabela vazia; slots alocados na arena a, textos internados em nomes */
+void inicializarTabela(TabelaHash *t, Arena *a, Internador *nomes) {
+    t->slots = NULL;
+    t->capacidade = 0;
+    t->tamanho = 0;
+    t->arena = a;
+    t->nomes = nomes;
+}
+
+/* distância do slot i até o balde ideal da chave (id) */
+static unsigned int distanciaSonda(const TabelaHash *t, int chave, unsigned int i) {
+    return (i - ((unsigned int) chave & (t->capacidade - 1))) & (t->capacidade - 1);
+}
+
+/* procurarSlot: índice do slot com a chave, ou -1. Para assim que a distância do
+   ocupante fica menor que a nossa (invariante Robin Hood). */
+static long procurarSlot(const TabelaHash *t, int chave) {
+    if (t->tamanho == 0 || chave < 0) return -1;
+    unsigned int mascara = t->capacidade - 1;
+    unsigned int i = (unsigned int) chave & mascara;
+    for (unsigned int dist = 0; ; ++dist, i = (i + 1) & mascara) {
+        const EntradaHash *e = &t->slots[i];
+        if (e->pista < 0 || distanciaSonda(t, e->pista, i) < dist) return -1;
+        if (e->pista == chave) return (long) i;
+    }
+}
+
+/* colocarEntrada: insere uma entrada nova (chave ausente) deslocando as mais "ricas" */
+static void colocarEntrada(TabelaHash *t, EntradaHash e) {
+    unsigned int mascara = t->capacidade - 1;
+    unsigned int i = (unsigned int) e.pista & mascara;
+    for (unsigned int dist = 0; ; ++dist, i = (i + 1) & mascara) {
+        EntradaHash *slot = &t->slots[i];
+        if (slot->pista < 0) {
+            *slot = e;
+            t->tamanho++;
+            return;
+        }
+        unsigned int distOcupante = distanciaSonda(t, slot->pista, i);
+        if (distOcupante < dist) {
+            EntradaHash tmp = *slot;
+            *slot = e;
+            e = tmp;
+            dist = distOcupante;
+        }
+    }
+}
+
+/* crescerTabela: dobra a capacidade e reinsere as entradas.
+   O vetor antigo fica na arena (o desperdício total é limitado pela série geométrica). */
+static void crescerTabela(TabelaHash *t) {
+    unsigned int capAntiga = t->capacidade;
+    EntradaHash *antigos = t->slots;
+    t->capacidade = capAntiga ? capAntiga * 2 : TABELA_CAP_INICIAL;
+    t->slots = (EntradaHash*) arenaAlocar(t->arena, t->capacidade * sizeof(EntradaHash));
+    memset(t->slots, 0xff, t->capacidade * sizeof(EntradaHash));
+    t->tamanho = 0;
+    for (unsigned int i = 0; i < capAntiga; ++i)
+        if (antigos[i].pista >= 0) colocarEntrada(t, antigos[i]);
+}
+
+/* inserirNaHashIds: associa pista -> suspeito (ids); se a pista já existe, o valor é
+   substituído (mesmo efeito observável da versão encadeada, onde a inserção mais recente prevalece). */
+void inserirNaHashIds(TabelaHash *t, int pista, int suspeito) {
+    long idx = procurarSlot(t, pista);
+    if (idx >= 0) {
+        t->slots[idx].suspeito = suspeito;
+        return;
+    }
+    /* mantém carga <= 7/8 */
+    if ((t->tamanho + 1) * 8 > t->capacidade * 7) crescerTabela(t);
+    EntradaHash e = { pista, suspeito };
+    colocarEntrada(t, e);
+}
+
+/* inserirNaHash: interna pista e suspeito e registra a associação */
+void inserirNaHash(TabelaHash *t, const char *pista, const char *suspeito) {
+    inserirNaHashIds(t, internar(t->nomes, pista), internar(t->nomes, suspeito));
+}
+
+/* encontrarSuspeitoId: id do suspeito associado à pista (id), ou -1 */
+int encontrarSuspeitoId(const TabelaHash *t, int pista) {
+    long idx = procurarSlot(t, pista);
+    return idx < 0 ? -1 : t->slots[idx].suspeito;
+}
+
+/* encontrarSuspeito: retorna ponteiro para string do suspeito (ou NULL se não existir).
+   Associações inseridas em tempo de execução têm precedência sobre a tabela estática. */
+const char* encontrarSuspeito(const TabelaHash *t, const char *pista) {
+    INSTR_TEMPO_INICIO(tBusca, "dq.encontrarSuspeito.ns");
+    const char *s = textoDoId(t->nomes, encontrarSuspeitoId(t, procurarId(t->nomes, pista)));
+    if (!s) {
+        INSTR_CONTAR("dq.encontrarSuspeito.tabelaEstatica");
+        s = suspeitoFixo(pista);
+    }
+    INSTR_TEMPO_FIM(tBusca);
+    return s;
+}
+
+static int alturaAVL(const PistaNode *n) {
+    return n ? n->altura : 0;
+}
+
+static void atualizarAltura(PistaNode *n) {
+    int he = alturaAVL(n->esq), hd = alturaAVL(n->dir);
+    n->altura = (he > hd ? he : hd) + 1;
+}
+
+static PistaNode* rotacaoDireita(PistaNode *n) {
+    PistaNode *e = n->esq;
+    n->esq = e->dir;
+    e->dir = n;
+    atualizarAltura(n);
+    atualizarAltura(e);
+    return e;
+}
+
+static PistaNode* rotacaoEsquerda(PistaNode *n) {
+    PistaNode *d = n->dir;
+    n->dir = d->esq;
+    d->esq = n;
+    atualizarAltura(n);
+    atualizarAltura(d);
+    return d;
+}
+
+/* rebalancear: aplica a rotação simples ou dupla necessária e devolve a nova raiz local */
+static PistaNode* rebalancear(PistaNode *n) {
+    atualizarAltura(n);
+    int fator = alturaAVL(n->esq) - alturaAVL(n->dir);
+    if (fator > 1) {
+        if (alturaAVL(n->esq->esq) < alturaAVL(n->esq->dir)) n->esq = rotacaoEsquerda(n->esq);
+        return rotacaoDireita(n);
+    }
+    if (fator < -1) {
+        if (alturaAVL(n->dir->dir) < alturaAVL(n->dir->esq)) n->dir = rotacaoDireita(n->dir);
+        return rotacaoEsquerda(n);
+    }
+    return n;
+}
+
+/* inserirPista: insere o id da pista unicamente numa AVL (evita duplicatas), sem recursão.
+   A árvore é ordenada por id: cada passo da descida é uma comparação de inteiros.
+   Desce guardando o caminho (ponteiros para os links) e rebalanceia na volta. */
+PistaNode* inserirPista(Arena *a, PistaNode *root, int id, int *inserida) {
+    PistaNode **caminho[AVL_ALTURA_MAX];
+    int prof = 0;
+    PistaNode **link = &root;
+    *inserida = 0;
+    while (*link) {
+        if (id == (*link)->id) { /* já existe: não duplicar */
+            INSTR_CONTAR("dq.inserirPista.duplicadas");
+            return root;
+        }
+        caminho[prof++] = link;
+        link = id < (*link)->id ? &(*link)->esq : &(*link)->dir;
+    }
+
+    PistaNode *n = (PistaNode*) arenaAlocar(a, sizeof(PistaNode));
+    n->id = id;
+    n->esq = n->dir = NULL;
+    n->altura = 1;
+    *link = n;
+    *inserida = 1;
+    INSTR_HISTOGRAMA("dq.inserirPista.profundidade", prof);
+
+    while (prof > 0) {
+        PistaNode **l = caminho[--prof];
+        int alturaAntes = (*l)->altura;
+        *l = rebalancear(*l);
+        if ((*l)->altura == alturaAntes) break; /* acima daqui nada muda */
+    }
+    return root;
+}
+
+/* adicionarPistaId: wrapper que atualiza a raiz da BST da sessão e, se a pista é nova,
+   os índices de suspeitos e de trigramas (a associação pista -> suspeito deve já estar na hash).
+   Retorna 1 se a pista é nova. */
+int adicionarPistaId(Sessao *sessao, int id) {
+    int inserida;
+    sessao->pistas = inserirPista(&sessao->arena, sessao->pistas, id, &inserida);
+    if (!inserida) return 0;
+    int suspeito = suspeitoDaPista(sessao, id);
+    if (suspeito >= 0) registrarPistaNoIndice(&sessao->indice, suspeito, id);
+    registrarPistaNosTrigramas(&sessao->trigramas, id, textoDoId(&sessao->nomes, id));
+    return 1;
+}
+
+/* suspeitoDaPista: id do suspeito de uma pista (id): primeiro a hash dinâmica, depois
+   a tabela estática. A consulta por texto à tabela estática (e a internação do suspeito)
+   acontece uma vez por id; o resultado fica em suspeitoFixoDe, que cresce sob demanda
+   na arena. Nada é montado no início da sessão. -1 se nenhum. */
+int suspeitoDaPista(Sessao *sessao, int pista) {
+    int suspeito = encontrarSuspeitoId(&sessao->hash, pista);
+    if (suspeito >= 0 || pista < 0) return suspeito;
+    if (pista >= sessao->numFixoDe) {
+        int cap = sessao->numFixoDe > 0 ? sessao->numFixoDe : TABELA_CAP_INICIAL;
+        while (cap <= pista || cap < sessao->nomes.numIds) cap *= 2;
+        int *novo = (int*) arenaAlocar(&sessao->arena, (size_t) cap * sizeof(int));
+        for (int id = 0; id < cap; ++id)
+            novo[id] = id < sessao->numFixoDe ? sessao->suspeitoFixoDe[id] : FIXO_NAO_RESOLVIDO;
+        sessao->suspeitoFixoDe = novo;
+        sessao->numFixoDe = cap;
+    }
+    if (sessao->suspeitoFixoDe[pista] == FIXO_NAO_RESOLVIDO) {
+        const char *fixo = suspeitoFixo(textoDoId(&sessao->nomes, pista));
+        sessao->suspeitoFixoDe[pista] = fixo ? internar(&sessao->nomes, fixo) : -1;
+    }
+    return sessao->suspeitoFixoDe[pista];
+}
+
+/* inicializarIndice: nenhum suspeito; vetores alocados na arena a sob demanda */
+void inicializarIndice(IndiceSuspeitos *idx, Arena *a) {
+    idx->contagem = idx->posicao = idx->ordem = NULL;
+    idx->listas = NULL;
+    idx->capIds = idx->numSuspeitos = 0;
+    idx->inicioFaixa = idx->quantosComContagem = NULL;
+    idx->capContagens = 0;
+    idx->arena = a;
+}
+
+/* crescerVetorInt: novo vetor de novaCap ints na arena, com os cap primeiros copiados
+   e o restante preenchido com valorInicial (o vetor antigo fica na arena) */
+static int* crescerVetorInt(Arena *a, const int *antigo, int cap, int novaCap, int valorInicial) {
+    int *novo = (int*) arenaAlocar(a, novaCap * sizeof(int));
+    if (cap > 0) memcpy(novo, antigo, cap * sizeof(int));
+    for (int i = cap; i < novaCap; ++i) novo[i] = valorInicial;
+    return novo;
+}
+
+/* registrarPistaNoIndice: contabiliza uma pista nova contra o suspeito em O(1).
+   A ordem decrescente é mantida trocando o suspeito com o primeiro da sua faixa de
+   contagem antes de incrementá-lo (as faixas de contagem são contíguas em ordem[]). */
+void registrarPistaNoIndice(IndiceSuspeitos *idx, int suspeito, int pista) {
+    if (suspeito >= idx->capIds) {
+        int novaCap = idx->capIds ? idx->capIds : TABELA_CAP_INICIAL;
+        while (novaCap <= suspeito) novaCap *= 2;
+        idx->contagem = crescerVetorInt(idx->arena, idx->contagem, idx->capIds, novaCap, 0);
+        idx->posicao = crescerVetorInt(idx->arena, idx->posicao, idx->capIds, novaCap, -1);
+        idx->ordem = crescerVetorInt(idx->arena, idx->ordem, idx->capIds, novaCap, -1);
+        ItemIndice **listas = (ItemIndice**) arenaAlocar(idx->arena, novaCap * sizeof(ItemIndice*));
+        if (idx->capIds > 0) memcpy(listas, idx->listas, idx->capIds * sizeof(ItemIndice*));
+        for (int i = idx->capIds; i < novaCap; ++i) listas[i] = NULL;
+        idx->listas = listas;
+        idx->capIds = novaCap;
+    }
+    int c = idx->contagem[suspeito];
+    if (c + 1 >= idx->capContagens) {
+        int novaCap = idx->capContagens ? idx->capContagens * 2 : TABELA_CAP_INICIAL;
+        idx->inicioFaixa = crescerVetorInt(idx->arena, idx->inicioFaixa, idx->capContagens, novaCap, 0);
+        idx->quantosComContagem = crescerVetorInt(idx->arena, idx->quantosComContagem, idx->capContagens, novaCap, 0);
+        idx->capContagens = novaCap;
+    }
+
+    ItemIndice *item = (ItemIndice*) arenaAlocar(idx->arena, sizeof(ItemIndice));
+    item->pista = pista;
+    item->prox = idx->listas[suspeito];
+    idx->listas[suspeito] = item;
+
+    int p = idx->posicao[suspeito];
+    if (p < 0) {
+        /* primeiro registro: entra no fim (contagem 0 é a menor faixa) */
+        p = idx->numSuspeitos++;
+        idx->ordem[p] = suspeito;
+    }
+    int j = (c == 0) ? p : idx->inicioFaixa[c];
+    int outro = idx->ordem[j];
+    idx->ordem[j] = suspeito;
+    idx->ordem[p] = outro;
+    idx->posicao[outro] = p;
+    idx->posicao[suspeito] = j;
+    if (c > 0) {
+        idx->inicioFaixa[c] = j + 1;
+        idx->quantosComContagem[c]--;
+    }
+    if (idx->quantosComContagem[c + 1] == 0) idx->inicioFaixa[c + 1] = j;
+    idx->quantosComContagem[c + 1]++;
+    idx->contagem[suspeito] = c + 1;
+}
+
+/* contarPistasContra: nº de pistas coletadas que apontam para o suspeito (id), em O(1) */
+int contarPistasContra(const IndiceSuspeitos *idx, int suspeito) {
+    return (suspeito >= 0 && suspeito < idx->capIds) ? idx->contagem[suspeito] : 0;
+}
+
+/* rankingSuspeitos: expõe os suspeitos com pelo menos uma pista, do mais ao menos
+   apontado, sem percorrer nada; retorna quantos são */
+int rankingSuspeitos(const IndiceSuspeitos *idx, const int **ordem) {
+    *ordem = idx->ordem;
+    return idx->numSuspeitos;
+}
+
+/* mostrarRanking: exibe o ranking com as pistas de cada suspeito, limitado aos
+   maxSuspeitos primeiros e a maxPistas pistas de cada um (-1 = sem limite) */
+void mostrarRanking(const IndiceSuspeitos *idx, const Internador *nomes, int maxSuspeitos, int maxPistas) {
+    const int *ordem;
+    int n = rankingSuspeitos(idx, &ordem);
+    int mostrar = (maxSuspeitos >= 0 && maxSuspeitos < n) ? maxSuspeitos : n;
+    for (int i = 0; i < mostrar; ++i) {
+        int s = ordem[i];
+        printf("  %d. %s (%d pista(s))", i + 1, textoDoId(nomes, s), idx->contagem[s]);
+        if (maxPistas != 0) printf(":");
+        int k = 0;
+        for (const ItemIndice *it = idx->listas[s]; it && k != maxPistas; it = it->prox, ++k)
+            printf(" \"%s\"", textoDoId(nomes, it->pista));
+        if (k < idx->contagem[s] && maxPistas != 0) printf(" ...");
+        printf("\n");
+    }
+    if (mostrar < n) printf("  ... e mais %d suspeito(s)\n", n - mostrar);
+}
+
+/* adicionarPista: interna o texto da pista e a adiciona à BST */
+void adicionarPista(Sessao *sessao, const char *texto) {
+    adicionarPistaId(sessao, internar(&sessao->nomes, texto));
+}
+
+/* inicializarTrigramas: nenhuma pista; vetores alocados na arena a sob demanda */
+void inicializarTrigramas(IndiceTrigramas *idx, Arena *a) {
+    idx->pistas = NULL;
+    idx->numPistas = idx->capPistas = 0;
+    idx->listas = NULL;
+    idx->capListas = idx->numListas = 0;
+    idx->arena = a;
+}
+
+/* chave do trigrama que começa em s (s[0..2] não nulos) */
+static uint32_t chaveTrigrama(const char *s) {
+    const unsigned char *u = (const unsigned char*) s;
+    return (uint32_t) u[0] | (uint32_t) u[1] << 8 | (uint32_t) u[2] << 16;
+}
+
+/* slot da chave na tabela de listas: o que a contém ou o livre onde entraria */
+static unsigned int slotTrigrama(const IndiceTrigramas *idx, uint32_t chave) {
+    unsigned int mascara = idx->capListas - 1;
+    uint32_t h = chave * 0x9E3779B1u;
+    unsigned int i = (h ^ (h >> 16)) & mascara;
+    while (idx->listas[i].chave != TRIGRAMA_VAZIO && idx->listas[i].chave != chave)
+        i = (i + 1) & mascara;
+    return i;
+}
+
+/* listaTrigrama: lista da chave, ou NULL se nenhuma pista coletada contém o trigrama */
+static const ListaTrigrama* listaTrigrama(const IndiceTrigramas *idx, uint32_t chave) {
+    if (idx->numListas == 0) return NULL;
+    const ListaTrigrama *l = &idx->listas[slotTrigrama(idx, chave)];
+    return l->chave == chave ? l : NULL;
+}
+
+/* crescerTrigramas: dobra a tabela de listas (carga <= 1/2); só os cabeçalhos são
+   movidos, os itens continuam onde estão na arena */
+static void crescerTrigramas(IndiceTrigramas *idx) {
+    unsigned int capAntiga = idx->capListas;
+    ListaTrigrama *antigas = idx->listas;
+    idx->capListas = capAntiga ? capAntiga * 2 : TABELA_CAP_INICIAL;
+    idx->listas = (ListaTrigrama*) arenaAlocar(idx->arena, idx->capListas * sizeof(ListaTrigrama));
+    memset(idx->listas, 0, idx->capListas * sizeof(ListaTrigrama));
+    for (unsigned int i = 0; i < capAntiga; ++i)
+        if (antigas[i].chave != TRIGRAMA_VAZIO) idx->listas[slotTrigrama(idx, antigas[i].chave)] = antigas[i];
+}
+
+/* registrarPistaNosTrigramas: dá à pista (nova) o próximo número de coleta e o anexa à
+   lista de cada trigrama do texto. Como os números só crescem, as listas ficam ordenadas
+   sem custo; um trigrama repetido no mesmo texto é anexado uma vez só. */
+void registrarPistaNosTrigramas(IndiceTrigramas *idx, int pista, const char *texto) {
+    if (idx->numPistas == idx->capPistas) {
+        int novaCap = idx->capPistas ? idx->capPistas * 2 : TABELA_CAP_INICIAL;
+        idx->pistas = crescerVetorInt(idx->arena, idx->pistas, idx->capPistas, novaCap, -1);
+        idx->capPistas = novaCap;
+    }
+    int num = idx->numPistas++;
+    idx->pistas[num] = pista;
+    if (!texto) return;
+
+    for (const char *t = texto; t[0] && t[1] && t[2]; ++t) {
+        uint32_t chave = chaveTrigrama(t);
+        if ((idx->numListas + 1) * 2 > idx->capListas) crescerTrigramas(idx);
+        ListaTrigrama *l = &idx->listas[slotTrigrama(idx, chave)];
+        if (l->chave == TRIGRAMA_VAZIO) {
+            l->chave = chave;
+            idx->numListas++;
+        } else if (l->itens[l->tam - 1] == num) {
+            continue;
+        }
+        if (l->tam == l->cap) {
+            int novaCap = l->cap ? l->cap * 2 : 4;
+            l->itens = crescerVetorInt(idx->arena, l->itens, l->cap, novaCap, -1);
+            l->cap = novaCap;
+        }
+        l->itens[l->tam++] = num;
+    }
+}
+
+/* primeira posição de v[ini..n) com valor >= x: passos que dobram a partir de ini e
+   busca binária no último intervalo (barato quando a lista menor é muito menor) */
+static int galopar(const int *v, int ini, int n, int x) {
+    int passo = 1, fim = ini;
+    while (fim < n && v[fim] < x) {
+        ini = fim + 1;
+        fim += passo;
+        passo *= 2;
+    }
+    if (fim > n) fim = n;
+    while (ini < fim) {
+        int meio = ini + (fim - ini) / 2;
+        if (v[meio] < x) ini = meio + 1;
+        else fim = meio;
+    }
+    return ini;
+}
+
+/* buscarPistasPorTrecho: pistas coletadas cujo texto contém trecho, na ordem de coleta.
+   Com 3 ou mais bytes, intersecta as listas dos trigramas do trecho começando pela menor
+   e confere as candidatas com strstr (trigramas presentes não garantem que estejam
+   contíguos); trechos menores percorrem o vetor de pistas coletadas. Devolve quantas
+   são e, em *ids, um vetor que o chamador libera com free(). */
+int buscarPistasPorTrecho(const Sessao *sessao, const char *trecho, int **ids) {
+    const IndiceTrigramas *idx = &sessao->trigramas;
+    size_t tam = strlen(trecho);
+    int numListas = tam >= 3 ? (int)(tam - 2) : 0;
+    const ListaTrigrama **listas = NULL;
+    int numCand = idx->numPistas;
+    if (numListas > 0) {
+        listas = (const ListaTrigrama**) malloc(numListas * sizeof(ListaTrigrama*));
+        if (!listas) { perror("malloc buscarPistasPorTrecho"); exit(1); }
+        for (int i = 0; i < numListas; ++i) {
+            const ListaTrigrama *l = listaTrigrama(idx, chaveTrigrama(trecho + i));
+            if (!l) { numCand = 0; break; }
+            /* inserção ordenada por tamanho: trechos têm poucos trigramas */
+            int j = i;
+            for (; j > 0 && listas[j-1]->tam > l->tam; --j) listas[j] = listas[j-1];
+            listas[j] = l;
+        }
+        if (numCand > 0) numCand = listas[0]->tam;
+    }
+
+    int *cand = (int*) malloc((numCand > 0 ? numCand : 1) * sizeof(int));
+    if (!cand) { perror("malloc buscarPistasPorTrecho"); exit(1); }
+    if (numListas == 0) {
+        for (int i = 0; i < numCand; ++i) cand[i] = i;
+    } else if (numCand > 0) {
+        memcpy(cand, listas[0]->itens, numCand * sizeof(int));
+        for (int k = 1; k < numListas && numCand > 0; ++k) {
+            const ListaTrigrama *l = listas[k];
+            if (l == listas[k-1]) continue; /* trigrama repetido no trecho */
+            int n = 0, pos = 0;
+            for (int i = 0; i < numCand && pos < l->tam; ++i) {
+                pos = galopar(l->itens, pos, l->tam, cand[i]);
+                if (pos < l->tam && l->itens[pos] == cand[i]) cand[n++] = cand[i];
+            }
+            numCand = n;
+        }
+    }
+    free(listas);
+
+    int n = 0;
+    for (int i = 0; i < numCand; ++i) {
+        int pista = idx->pistas[cand[i]];
+        if (strstr(textoDoId(&sessao->nomes, pista), trecho)) cand[n++] = pista;
+    }
+    INSTR_HISTOGRAMA("dq.buscarPistasPorTrecho.candidatas", numCand);
+    *ids = cand;
+    return n;
+}
+
+/* mostrarBuscaPorTrecho: lista as pistas coletadas que contêm o trecho */
+void mostrarBuscaPorTrecho(const Sessao *sessao, const char *trecho) {
+    int *ids;
+    int n = buscarPistasPorTrecho(sessao, trecho, &ids);
+    printf("\n--- Pistas com \"%s\": %d ---\n", trecho, n);
+    for (int i = 0; i < n; ++i) printf("  - %s\n", textoDoId(&sessao->nomes, ids[i]));
+    free(ids);
+}
+
+/* pistaAssociadaASala: pista estática de cada sala (SALAS_FIXAS, via hash perfeito) */
+const char* pistaAssociadaASala(const char *nomeSala) {
+    int i = buscaPerfeita(SALAS_FIXAS, PHF_SALAS_DESLOC, PHF_SALAS_ORDEM,
+                          PHF_SALAS_N, PHF_SALAS_BALDES, nomeSala);
+    /* salas sem pista retornam NULL */
+    return i < 0 ? NULL : SALAS_FIXAS[i].valor;
+}
+
+/* explorarSalas: navegação interativa com coleta de pistas.
+   - Parametros: a sessão (mansão plana, começando pela raiz, BST de pistas coletadas e
+     tabela hash já populada com associações pista->suspeito).
+   - Navegação: 'e' esquerda, 'd' direita, 'v' voltar ao pai (usamos pai para permitir voltar),
+     's' sair. Em cada visita, exibe sala e pista (se existir) e armazena a pista na BST.
+*/
+void explorarSalas(Sessao *sessao) {
+    const MansaoPlana *m = &sessao->plana;
+    if (m->numSalas == 0) return;
+    uint32_t pos = 0; /* a raiz é sempre o índice 0 */
+    char buffer[64];
+    while (1) {
+        int pista = m->nos[pos].pista;
+        printf("\nVocê está na sala: %s\n", nomeDaSala(m, pos));
+        if (pista >= 0) {
+            printf("  -> Você encontrou uma pista: \"%s\"\n", textoDoId(&sessao->nomes, pista));
+            /* adiciona na BST (não duplica) */
+            adicionarPistaId(sessao, pista);
+        } else {
+            printf("  -> Nenhuma pista aparente nesta sala.\n");
+        }
+
+        mostrarSalaOpcoes(m, pos);
+        if (!fgets(buffer, sizeof(buffer), stdin)) break;
+        limpaNewline(buffer);
+        if (strlen(buffer) == 0) { printf("Opção vazia. Tente novamente.\n"); continue; }
+        char cmd = buffer[0];
+
+        int r = passoExploracao(m, &pos, cmd);
+        if (r == PASSO_SAIR) {
+            printf("Saindo da exploração.\n");
+            return;
+        } else if (r == PASSO_SEM_SALA) {
+            if (cmd == 'e') printf("Não há sala à esquerda.\n");
+            else if (cmd == 'd') printf("Não há sala à direita.\n");
+            else printf("Você está na raiz; não há sala pai.\n");
+        } else if (r == PASSO_INVALIDO) {
+            printf("Comando desconhecido. Use 'e' (esq), 'd' (dir), 'v' (voltar), 's' (sair).\n");
+        }
+    }
+}
+
+/* passoExploracao: aplica um comando à posição atual, sem E/S; é o motor comum da
+   exploração interativa e da roteirizada */
+int passoExploracao(const MansaoPlana *m, uint32_t *pos, char cmd) {
+    uint32_t destino;
+    switch (cmd) {
+        case 's': return PASSO_SAIR;
+        case 'e': destino = m->nos[*pos].esq; break;
+        case 'd': destino = m->nos[*pos].dir; break;
+        case 'v': destino = m->nos[*pos].pai; break;
+        default: return PASSO_INVALIDO;
+    }
+    if (destino == SALA_NENHUMA) return PASSO_SEM_SALA;
+    *pos = destino;
+    return PASSO_MOVEU;
+}
+
+/* explorarRoteiro: mesma semântica de explorarSalas (a sala atual é revisitada após cada
+   comando que não seja 's'), mas consumindo os comandos de cmds[0..n) sem imprimir nada.
+   Espaços e quebras de linha são ignorados; os contadores são acumulados em r. */
+void explorarRoteiro(Sessao *sessao, const char *cmds, size_t n, ResultadoRoteiro *r) {
+    const MansaoPlana *m = &sessao->plana;
+    if (m->numSalas == 0) return;
+    clock_t inicio = clock();
+    uint32_t pos = 0;
+    int moveu = 1;
+    for (size_t i = 0; ; ++i) {
+        int pista = m->nos[pos].pista;
+        if (moveu && pista >= 0) {
+            r->visitasComPista++;
+            r->pistasNovas += adicionarPistaId(sessao, pista);
+        }
+        while (i < n && (cmds[i] == ' ' || cmds[i] == '\n' || cmds[i] == '\r' || cmds[i] == '\t')) i++;
+        if (i >= n) break;
+        r->passos++;
+        int res = passoExploracao(m, &pos, cmds[i]);
+        if (res == PASSO_SAIR) break;
+        moveu = res == PASSO_MOVEU;
+        r->movimentos += moveu;
+    }
+    r->segundos += (double)(clock() - inicio) / CLOCKS_PER_SEC;
+}
+
+/* gerarPasseio: roteiro aleatório de numPassos comandos sempre válidos (cada passo escolhe
+   uniformemente entre as saídas existentes da sala); o chamador libera com free() */
+char* gerarPasseio(const MansaoPlana *m, long numPassos) {
+    if (numPassos < 0 || m->numSalas == 0) numPassos = 0;
+    char *cmds = (char*) malloc((size_t) numPassos + 1);
+    if (!cmds) { perror("malloc gerarPasseio"); exit(1); }
+    uint32_t pos = 0;
+    for (long i = 0; i < numPassos; ++i) {
+        const NoMansao *no = &m->nos[pos];
+        char opcoes[3];
+        int k = 0;
+        if (no->esq != SALA_NENHUMA) opcoes[k++] = 'e';
+        if (no->dir != SALA_NENHUMA) opcoes[k++] = 'd';
+        if (no->pai != SALA_NENHUMA) opcoes[k++] = 'v';
+        if (k == 0) { numPassos = i; break; } /* mansão de uma sala só */
+        cmds[i] = opcoes[prngIntervalo(&aleatorio, (uint32_t) k)];
+        passoExploracao(m, &pos, cmds[i]);
+    }
+    cmds[numPassos] = '\0';
+    return cmds;
+}
+
+/* mostrarResultadoRoteiro: vazão da exploração e estado final da investigação */
+void mostrarResultadoRoteiro(const ResultadoRoteiro *r, const Sessao *sessao) {
+    double seg = r->segundos > 0 ? r->segundos : 1e-9;
+    printf("Exploração roteirizada: %ld passos (%ld movimentos) em %.3f s\n",
+           r->passos, r->movimentos, r->segundos);
+    printf("  %.0f passos/s | %.0f pistas/s (%ld visitas com pista, %ld pistas distintas)\n",
+           r->passos / seg, r->visitasComPista / seg, r->visitasComPista, r->pistasNovas);
+    printf("Ranking de suspeitos:\n");
+    mostrarRanking(&sessao->indice, &sessao->nomes, RANKING_RESUMO_SUSPEITOS, RANKING_RESUMO_PISTAS);
+}
+
+/* Planejador de rotas. Visitar as salas a e b (pistas distintas do mesmo suspeito) saindo
+   da raiz custa prof(a) + dist(a, b); com l = LCA(a, b), indo primeiro à mais rasa, isso
+   dá 2*min(pa, pb) + max(pa, pb) - 2*pl. Para um l fixo o melhor par da subárvore de l é
+   (s1, s2): s1 a sala mais rasa do suspeito e s2 a mais rasa com pista diferente da de s1.
+   Esse par sai dos pares dos filhos mais a própria sala, em ordem BFS reversa e sem
+   recursão. Cada sala guarda um conjunto suspeito -> par só com os suspeitos da sua
+   subárvore; o conjunto do filho menor é fundido no do maior (menor no maior: cada
+   entrada muda de conjunto O(log n) vezes), então o total é O(n log n) para todos os
+   suspeitos juntos. Um par que não mudou numa sala custa mais nela do que no filho,
+   onde já foi avaliado: só as entradas tocadas em cada sala são avaliadas. Avaliar l
+   acima do LCA verdadeiro só superestima o custo, então o mínimo encontrado é o ótimo. */
+_Static_assert(PISTAS_PARA_CONDENAR == 2, "planejarRotas combina pares de salas");
+
+/* escolherPar: (s1, s2) entre os candidatos, segundo a regra acima */
+static void escolherPar(const MansaoPlana *m, const uint32_t prof[], const uint32_t cand[], int nc,
+                        uint32_t par[2]) {
+    par[0] = par[1] = SALA_NENHUMA;
+    for (int i = 0; i < nc; ++i)
+        if (cand[i] != SALA_NENHUMA && (par[0] == SALA_NENHUMA || prof[cand[i]] < prof[par[0]]))
+            par[0] = cand[i];
+    if (par[0] == SALA_NENHUMA) return;
+    int pista = m->nos[par[0]].pista;
+    for (int i = 0; i < nc; ++i)
+        if (cand[i] != SALA_NENHUMA && m->nos[cand[i]].pista != pista &&
+            (par[1] == SALA_NENHUMA || prof[cand[i]] < prof[par[1]]))
+            par[1] = cand[i];
+}
+
+/* Conjunto suspeito -> par (s1, s2) de uma subárvore, em endereçamento aberto */
+typedef struct {
+    int suspeito; /* -1 = slot vazio */
+    uint32_t par[2];
+} ParSuspeito;
+
+typedef struct {
+    ParSuspeito *itens;
+    uint32_t cap; /* potência de 2 */
+    uint32_t tam;
+} ConjuntoPares;
+
+static ConjuntoPares* criarConjuntoPares(uint32_t cap) {
+    ConjuntoPares *c = (ConjuntoPares*) malloc(sizeof(ConjuntoPares));
+    ParSuspeito *itens = (ParSuspeito*) malloc(cap * sizeof(ParSuspeito));
+    if (!c || !itens) { perror("malloc planejarRotas"); exit(1); }
+    for (uint32_t i = 0; i < cap; ++i) itens[i].suspeito = -1;
+    c->itens = itens;
+    c->cap = cap;
+    c->tam = 0;
+    return c;
+}
+
+static void liberarConjuntoPares(ConjuntoPares *c) {
+    if (!c) return;
+    free(c->itens);
+    free(c);
+}
+
+/* entradaDoSuspeito: entrada de s no conjunto, criada com par vazio se faltava
+   (carga <= 1/2; o vetor dobra quando precisa) */
+static ParSuspeito* entradaDoSuspeito(ConjuntoPares *c, int s) {
+    if ((c->tam + 1) * 2 > c->cap) {
+        ParSuspeito *antigos = c->itens;
+        uint32_t capAntiga = c->cap;
+        c->cap *= 2;
+        c->itens = (ParSuspeito*) malloc(c->cap * sizeof(ParSuspeito));
+        if (!c->itens) { perror("malloc planejarRotas"); exit(1); }
+        for (uint32_t i = 0; i < c->cap; ++i) c->itens[i].suspeito = -1;
+        for (uint32_t i = 0; i < capAntiga; ++i) {
+            if (antigos[i].suspeito < 0) continue;
+            uint32_t j = ((uint32_t) antigos[i].suspeito * 0x9E3779B1u) & (c->cap - 1);
+            while (c->itens[j].suspeito >= 0) j = (j + 1) & (c->cap - 1);
+            c->itens[j] = antigos[i];
+        }
+        free(antigos);
+    }
+    uint32_t j = ((uint32_t) s * 0x9E3779B1u) & (c->cap - 1);
+    while (c->itens[j].suspeito >= 0 && c->itens[j].suspeito != s) j = (j + 1) & (c->cap - 1);
+    ParSuspeito *e = &c->itens[j];
+    if (e->suspeito < 0) {
+        e->suspeito = s;
+        e->par[0] = e->par[1] = SALA_NENHUMA;
+        c->tam++;
+    }
+    return e;
+}
+
+/* fundirPar: junta o par 'outro' ao par de s no conjunto da sala l e, se houver par
+   completo, avalia a rota com desvio em l */
+static void fundirPar(const MansaoPlana *m, const uint32_t prof[], uint32_t l, ConjuntoPares *c,
+                      int s, const uint32_t outro[2], const int rotaDe[], long melhor[], RotaSuspeito r[]) {
+    ParSuspeito *e = entradaDoSuspeito(c, s);
+    uint32_t cand[4] = { outro[0], outro[1], e->par[0], e->par[1] };
+    escolherPar(m, prof, cand, 4, e->par);
+    if (e->par[1] == SALA_NENHUMA) return;
+    int q = rotaDe[s];
+    long custo = 2L * prof[e->par[0]] + prof[e->par[1]] - 2L * prof[l];
+    if (melhor[q] < 0 || custo < melhor[q]) {
+        melhor[q] = custo;
+        r[q].salas[0] = e->par[0];
+        r[q].salas[1] = e->par[1];
+    }
+}
+
+/* escreverDescida: comandos e/d de 'de' até o descendente 'ate' (dist arestas), em buf */
+static void escreverDescida(const MansaoPlana *m, uint32_t de, uint32_t ate, uint32_t dist, char *buf) {
+    for (uint32_t x = ate; x != de; x = m->nos[x].pai)
+        buf[--dist] = m->nos[m->nos[x].pai].esq == x ? 'e' : 'd';
+}
+
+/* montarRota: roteiro raiz -> a -> b, com a no mínimo tão rasa quanto b */
+static void montarRota(const MansaoPlana *m, const uint32_t prof[], RotaSuspeito *r) {
+    uint32_t a = r->salas[0], b = r->salas[1], x = a, y = b;
+    while (prof[x] > prof[y]) x = m->nos[x].pai;
+    while (prof[y] > prof[x]) y = m->nos[y].pai;
+    while (x != y) { x = m->nos[x].pai; y = m->nos[y].pai; }
+    uint32_t subida = prof[a] - prof[x], descida = prof[b] - prof[x];
+    r->movimentos = (long) prof[a] + subida + descida;
+    r->comandos = (char*) malloc((size_t) r->movimentos + 1);
+    if (!r->comandos) { perror("malloc montarRota"); exit(1); }
+    escreverDescida(m, 0, a, prof[a], r->comandos);
+    memset(r->comandos + prof[a], 'v', subida);
+    escreverDescida(m, x, b, descida, r->comandos + prof[a] + subida);
+    r->comandos[r->movimentos] = '\0';
+}
+
+/* planejarRotas: rota mínima para cada suspeito que aparece na mansão da sessão.
+   Devolve quantos são; o vetor *rotas deve ser liberado com liberarRotas. */
+int planejarRotas(Sessao *sessao, RotaSuspeito **rotas) {
+    const MansaoPlana *m = &sessao->plana;
+    uint32_t n = m->numSalas;
+    *rotas = NULL;
+    if (n == 0) return 0;
+    uint32_t *prof = (uint32_t*) malloc(n * sizeof(uint32_t));
+    int *suspeitoDe = (int*) malloc(n * sizeof(int));
+    if (!prof || !suspeitoDe) { perror("malloc planejarRotas"); exit(1); }
+
+    /* profundidades (pai antes do filho na ordem BFS) e suspeito de cada sala */
+    for (uint32_t i = 0; i < n; ++i) {
+        prof[i] = i == 0 ? 0 : prof[m->nos[i].pai] + 1;
+        suspeitoDe[i] = m->nos[i].pista >= 0 ? suspeitoDaPista(sessao, m->nos[i].pista) : -1;
+    }
+    /* suspeitos presentes, na ordem de id */
+    int numIds = sessao->nomes.numIds;
+    char *presente = (char*) calloc(numIds > 0 ? (size_t) numIds : 1, 1);
+    if (!presente) { perror("calloc planejarRotas"); exit(1); }
+    int numRotas = 0;
+    for (uint32_t i = 0; i < n; ++i)
+        if (suspeitoDe[i] >= 0 && !presente[suspeitoDe[i]]) { presente[suspeitoDe[i]] = 1; numRotas++; }
+    RotaSuspeito *r = (RotaSuspeito*) malloc((numRotas > 0 ? (size_t) numRotas : 1) * sizeof(RotaSuspeito));
+    if (!r) { perror("malloc planejarRotas"); exit(1); }
+
+    /* rota de cada suspeito presente, na ordem de id; rotaDe[s] é o índice dela em r */
+    int *rotaDe = (int*) malloc((numIds > 0 ? (size_t) numIds : 1) * sizeof(int));
+    long *melhor = (long*) malloc((numRotas > 0 ? (size_t) numRotas : 1) * sizeof(long));
+    ConjuntoPares **conj = (ConjuntoPares**) calloc(n, sizeof(ConjuntoPares*));
+    if (!rotaDe || !melhor || !conj) { perror("malloc planejarRotas"); exit(1); }
+    int k = 0;
+    for (int s = 0; s < numIds; ++s) {
+        rotaDe[s] = -1;
+        if (!presente[s]) continue;
+        r[k].suspeito = s;
+        r[k].movimentos = -1;
+        r[k].comandos = NULL;
+        melhor[k] = -1;
+        rotaDe[s] = k++;
+    }
+
+    for (uint32_t i = n; i-- > 0; ) {
+        const NoMansao *no = &m->nos[i];
+        ConjuntoPares *a = no->esq != SALA_NENHUMA ? conj[no->esq] : NULL;
+        ConjuntoPares *b = no->dir != SALA_NENHUMA ? conj[no->dir] : NULL;
+        if (!a || (b && a->tam < b->tam)) { ConjuntoPares *t = a; a = b; b = t; }
+        if (!a && suspeitoDe[i] < 0) continue;
+        if (!a) a = criarConjuntoPares(4);
+        conj[i] = a;
+        /* só as entradas do conjunto menor e a da própria sala mudam nesta sala */
+        for (uint32_t t = 0; b && t < b->cap; ++t)
+            if (b->itens[t].suspeito >= 0)
+                fundirPar(m, prof, i, a, b->itens[t].suspeito, b->itens[t].par, rotaDe, melhor, r);
+        if (suspeitoDe[i] >= 0) {
+            uint32_t propria[2] = { i, SALA_NENHUMA };
+            fundirPar(m, prof, i, a, suspeitoDe[i], propria, rotaDe, melhor, r);
+        }
+        liberarConjuntoPares(b);
+    }
+    liberarConjuntoPares(conj[0]);
+    for (int q = 0; q < numRotas; ++q)
+        if (melhor[q] >= 0) montarRota(m, prof, &r[q]);
+
+    free(conj);
+    free(melhor);
+    free(rotaDe);
+    free(presente);
+    free(suspeitoDe);
+    free(prof);
+    *rotas = r;
+    return numRotas;
+}
+
+/* liberarRotas: libera os roteiros e o vetor devolvido por planejarRotas */
+void liberarRotas(RotaSuspeito *rotas, int n) {
+    for (int i = 0; i < n; ++i) free(rotas[i].comandos);
+    free(rotas);
+}
+
+/* mostrarRotas: custo e roteiro de cada suspeito (roteiros longos são abreviados) */
+void mostrarRotas(const RotaSuspeito *rotas, int n, const Internador *nomes) {
+    for (int i = 0; i < n; ++i) {
+        const RotaSuspeito *r = &rotas[i];
+        if (r->movimentos < 0) {
+            printf("  %s: impossível (menos de %d pistas distintas na mansão)\n",
+                   textoDoId(nomes, r->suspeito), PISTAS_PARA_CONDENAR);
+            continue;
+        }
+        printf("  %s: %ld movimento(s): %.60s%s\n", textoDoId(nomes, r->suspeito), r->movimentos,
+               r->comandos, r->movimentos > 60 ? "..." : "");
+    }
+}
+
+/* congelarSuspeitos: resolve, antes das threads, o suspeito de cada id de pista (dinâmico
+   ou estático, internando o que faltar). O vetor resultante não muda mais, então as
+   consultas concorrentes são leituras simples, sem trava. Liberar com free(). */
+int* congelarSuspeitos(Sessao *sessao) {
+    const MansaoPlana *m = &sessao->plana;
+    for (uint32_t i = 0; i < m->numSalas; ++i)
+        if (m->nos[i].pista >= 0) suspeitoDaPista(sessao, m->nos[i].pista);
+    int numIds = sessao->nomes.numIds;
+    int *suspeitoDe = (int*) malloc((numIds > 0 ? (size_t) numIds : 1) * sizeof(int));
+    if (!suspeitoDe) { perror("malloc congelarSuspeitos"); exit(1); }
+    for (int id = 0; id < numIds; ++id) suspeitoDe[id] = -1;
+    for (uint32_t i = 0; i < m->numSalas; ++i) {
+        int pista = m->nos[i].pista;
+        if (pista >= 0) suspeitoDe[pista] = suspeitoDaPista(sessao, pista);
+    }
+    return suspeitoDe;
+}
+
+/* passeioDetetive: corpo da thread; passeio aleatório com o Prng do próprio detetive
+   e contadores em variáveis locais, gravados só no fim */
+static void* passeioDetetive(void *arg) {
+    Detetive *d = (Detetive*) arg;
+    const MansaoPlana *m = d->mansao;
+    int *contagem = (int*) calloc(d->numIds > 0 ? (size_t) d->numIds : 1, sizeof(int));
+    if (!contagem) { perror("calloc passeioDetetive"); exit(1); }
+    Prng aleatorioLocal = d->aleatorio;
+    long visitas = 0, novas = 0;
+    int melhor = -1;
+    uint32_t pos = 0;
+    for (long i = 0; i <= d->passos; ++i) {
+        const NoMansao *no = &m->nos[pos];
+        if (no->pista >= 0) {
+            uint64_t bit = 1ull << (no->pista & 63);
+            uint64_t *palavra = &d->pistas[no->pista >> 6];
+            visitas++;
+            if (!(*palavra & bit)) {
+                *palavra |= bit;
+                novas++;
+                int s = d->suspeitoDe[no->pista];
+                if (s >= 0 && (++contagem[s], melhor < 0 || contagem[s] > contagem[melhor])) melhor = s;
+            }
+        }
+        if (i == d->passos) break;
+        uint32_t saidas[3];
+        int k = 0;
+        if (no->esq != SALA_NENHUMA) saidas[k++] = no->esq;
+        if (no->dir != SALA_NENHUMA) saidas[k++] = no->dir;
+        if (no->pai != SALA_NENHUMA) saidas[k++] = no->pai;
+        if (k == 0) break;
+        pos = saidas[prngIntervalo(&aleatorioLocal, (uint32_t) k)];
+    }
+    d->visitasComPista = visitas;
+    d->pistasNovas = novas;
+    d->melhorSuspeito = melhor;
+    d->melhorContagem = melhor >= 0 ? contagem[melhor] : 0;
+    free(contagem);
+    return NULL;
+}
+
+static double relogioParede(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* menorBitUm: índice do bit 1 menos significativo de x != 0 (De Bruijn, sem builtins) */
+static int menorBitUm(uint64_t x) {
+    static const int POSICAO[64] = {
+         0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6,
+    };
+    return POSICAO[((x & (0 - x)) * UINT64_C(0x03f79d71b4cb0a89)) >> 58];
+}
+
+/* explorarEmParalelo: numDetetives threads com passos cada sobre a mansão da sessão;
+   ao final funde os bitmaps na BST/índice da sessão (em ordem de id) e libera-os.
+   Devolve o tempo de parede só dos passeios (sem os callocs e sem a fusão serial). */
+double explorarEmParalelo(Sessao *sessao, const int *suspeitoDe, Detetive d[], int numDetetives, long passos) {
+    int numIds = sessao->nomes.numIds;
+    size_t palavras = (size_t) numIds / 64 + 1;
+    /* fluxos independentes: o detetive i usa o gerador global saltado i vezes */
+    Prng fluxo;
+    prngSemear(&fluxo, prngProximo(&aleatorio));
+    for (int i = 0; i < numDetetives; ++i) {
+        d[i].mansao = &sessao->plana;
+        d[i].suspeitoDe = suspeitoDe;
+        d[i].numIds = numIds;
+        d[i].passos = sessao->plana.numSalas > 0 ? passos : -1;
+        d[i].aleatorio = fluxo;
+        prngSaltar(&fluxo);
+        d[i].pistas = (uint64_t*) calloc(palavras, sizeof(uint64_t));
+        if (!d[i].pistas) { perror("calloc explorarEmParalelo"); exit(1); }
+    }
+    double inicio = relogioParede();
+    for (int i = 0; i < numDetetives; ++i) {
+        if (pthread_create(&d[i].thread, NULL, passeioDetetive, &d[i]) != 0) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+    for (int i = 0; i < numDetetives; ++i) pthread_join(d[i].thread, NULL);
+    double tempoPasseios = relogioParede() - inicio;
+    for (int i = 0; i < numDetetives; ++i) {
+        for (size_t w = 0; w < palavras; ++w)
+            for (uint64_t bits = d[i].pistas[w]; bits; bits &= bits - 1)
+                adicionarPistaId(sessao, (int)(w * 64 + (size_t) menorBitUm(bits)));
+        free(d[i].pistas);
+        d[i].pistas = NULL;
+    }
+    return tempoPasseios;
+}
+
+/* benchmarkDetetives: vazão com 1, 2, 4, ... maxDetetives threads (passos por detetive
+   fixos, então o ideal é tempo constante). A vazão usa só o tempo dos passeios; o resto
+   (callocs e fusão serial na sessão) sai em coluna própria. As pistas de todas as rodadas
+   são somadas à sessão. */
+void benchmarkDetetives(Sessao *sessao, int maxDetetives, long passos) {
+    if (maxDetetives < 1) maxDetetives = 1;
+    int *suspeitoDe = congelarSuspeitos(sessao);
+    Detetive *d = (Detetive*) malloc((size_t) maxDetetives * sizeof(Detetive));
+    if (!d) { perror("malloc benchmarkDetetives"); exit(1); }
+    printf("Detetives em paralelo: %ld passos por detetive, %u salas\n", passos, sessao->plana.numSalas);
+    printf("%10s | %11s | %10s | %14s | %10s\n", "detetives", "passeio (s)", "serial (s)", "passos/s",
+           "aceleracao");
+    double base = 0;
+    for (int t = 1; ; t = t * 2 < maxDetetives ? t * 2 : maxDetetives) {
+        double inicio = relogioParede();
+        double tempo = explorarEmParalelo(sessao, suspeitoDe, d, t, passos);
+        double serial = relogioParede() - inicio - tempo;
+        double vazao = tempo > 0 ? (double) passos * t / tempo : 0;
+        if (t == 1) base = vazao;
+        printf("%10d | %11.3f | %10.3f | %14.0f | %9.2fx\n", t, tempo, serial, vazao,
+               base > 0 ? vazao / base : 0);
+        if (t == maxDetetives) break;
+    }
+    for (int i = 0; i < maxDetetives && i < 8; ++i) {
+        printf("  detetive %d: %ld pistas distintas", i + 1, d[i].pistasNovas);
+        if (d[i].melhorSuspeito >= 0)
+            printf(", suspeita de %s (%d)", textoDoId(&sessao->nomes, d[i].melhorSuspeito), d[i].melhorContagem);
+        printf("\n");
+    }
+    printf("Ranking de suspeitos (pistas de todos os detetives):\n");
+    mostrarRanking(&sessao->indice, &sessao->nomes, RANKING_RESUMO_SUSPEITOS, RANKING_RESUMO_PISTAS);
+    free(d);
+    free(suspeitoDe);
+}
+
+static int compararTextos(const void *a, const void *b) {
+    return strcmp(*(const char* const*) a, *(const char* const*) b);
+}
+
+/* listarPistasBST: percorre em-ordem (pilha explícita) e mostra pistas coletadas.
+   A árvore está ordenada por id; só aqui, na exibição, os textos são ordenados. */
+void listarPistasBST(PistaNode *root, const Internador *nomes) {
+    const char **textos = (const char**) malloc((nomes->numIds > 0 ? nomes->numIds : 1) * sizeof(char*));
+    if (!textos) { perror("malloc listarPistasBST"); return; }
+    int n = 0;
+    PistaNode *pilha[AVL_ALTURA_MAX];
+    int topo = 0;
+    PistaNode *cur = root;
+    while (cur || topo > 0) {
+        while (cur) {
+            pilha[topo++] = cur;
+            cur = cur->esq;
+        }
+        cur = pilha[--topo];
+        textos[n++] = textoDoId(nomes, cur->id);
+        cur = cur->dir;
+    }
+    qsort(textos, n, sizeof(char*), compararTextos);
+    for (int i = 0; i < n; ++i) printf("  - %s\n", textos[i]);
+    free(textos);
+}
+
+/* verificarSuspeitoFinal: consulta no índice de suspeitos quantas pistas coletadas apontam
+   para o acusado (O(1), sem percorrer a BST). Se >= PISTAS_PARA_CONDENAR, acusação é bem-sucedida. */
+void verificarSuspeitoFinal(Sessao *sessao) {
+    if (!sessao->pistas) {
+        printf("Nenhuma pista coletada. Impossível julgar.\n");
+        return;
+    }
+    char acusado[64];
+    printf("\nDigite o nome do suspeito que deseja acusar: ");
+    if (!fgets(acusado, sizeof(acusado), stdin)) return;
+    limpaNewline(acusado);
+    if (strlen(acusado) == 0) {
+        printf("Nome vazio. Acusação cancelada.\n");
+        return;
+    }
+
+    int contador = contarPistasContra(&sessao->indice, procurarId(&sessao->nomes, acusado));
+
+    printf("\nResultado da acuação contra '%s':\n", acusado);
+    if (contador >= PISTAS_PARA_CONDENAR) {
+        printf("  Sucesso! %d pista(s) suportam a acusação. O culpado foi preso.\n", contador);
+    } else if (contador == 1) {
+        printf("  Há apenas 1 pista apontando para '%s'. Não é suficiente para condenar.\n", acusado);
+    } else {
+        printf("  Nenhuma pista aponta para '%s'. Acusação infundada.\n", acusado);
+    }
+}
+
+/* liberarHashEncadeada: libera cada cadeia na tabela hash encadeada */
+void liberarHashEncadeada(HashNode *hash[]) {
+    for (int i = 0; i < HASH_SIZE; ++i) {
+        HashNode *cur = hash[i];
+        while (cur) {
+            HashNode *next = cur->next;
+            free(cur->pista);
+            free(cur->suspeito);
+            free(cur);
+            cur = next;
+        }
+        hash[i] = NULL;
+    }
+}
+
+/* montarMapa: cria manualmente o mapa (árvore de salas), conecta pais e associa
+   a cada sala a pista definida em pistaAssociadaASala */
+void montarMapa(Sessao *sessao) {
+    Arena *a = &sessao->arena;
+    /* Exemplo de mansão fixa:
+               Entrada
+              /       \
+       Sala de Estar  Cozinha
+         /     \         \
+     Biblioteca Quarto   Garagem
+      /                /
+    Sotao           Jardim
+    (ajuste conforme desejar)
+    */
+    Sala *entrada = criarSala(a, "Entrada");
+    Sala *estar = criarSala(a, "Sala de Estar");
+    Sala *cozinha = criarSala(a, "Cozinha");
+    Sala *biblioteca = criarSala(a, "Biblioteca");
+    Sala *quarto = criarSala(a, "Quarto");
+    Sala *garagem = criarSala(a, "Garagem");
+    Sala *sotao = criarSala(a, "Sotao");
+    Sala *jardim = criarSala(a, "Jardim");
+    Sala *escritorio = criarSala(a, "Escritorio");
+    Sala *banheiro = criarSala(a, "Banheiro");
+
+    /* ligações */
+    entrada->esq = estar; estar->pai = entrada;
+    entrada->dir = cozinha; cozinha->pai = entrada;
+
+    estar->esq = biblioteca; biblioteca->pai = estar;
+    estar->dir = quarto; quarto->pai = estar;
+
+    biblioteca->esq = sotao; sotao->pai = biblioteca;
+    cozinha->dir = garagem; garagem->pai = cozinha;
+
+    garagem->esq = jardim; jardim->pai = garagem;
+
+    quarto->esq = escritorio; escritorio->pai = quarto;
+    quarto->dir = banheiro; banheiro->pai = quarto;
+
+    Sala *todas[] = { entrada, estar, cozinha, biblioteca, quarto, garagem, sotao, jardim, escritorio, banheiro };
+    for (size_t i = 0; i < sizeof(todas) / sizeof(todas[0]); ++i) {
+        const char *pista = pistaAssociadaASala(todas[i]->nome);
+        if (pista) todas[i]->pista = internar(&sessao->nomes, pista);
+    }
+
+    sessao->mapa = entrada;
+    achatarMansao(sessao);
+}
+
+/* lerArquivo: lê o arquivo inteiro num buffer terminado em '\0' (liberar com free) */
+char* lerArquivo(const char *caminho, size_t *tam) {
+    FILE *f = fopen(caminho, "rb");
+    if (!f) { perror(caminho); return NULL; }
+    fseek(f, 0, SEEK_END);
+    long fim = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (fim < 0) { perror(caminho); fclose(f); return NULL; }
+    char *buf = (char*) malloc((size_t) fim + 1);
+    if (!buf) { perror("malloc lerArquivo"); fclose(f); return NULL; }
+    *tam = fread(buf, 1, (size_t) fim, f);
+    buf[*tam] = '\0';
+    fclose(f);
+    return buf;
+}
+
+/* proximaLinha: termina a linha atual com '\0' (removendo '\r') e devolve o início da
+   seguinte; *linha recebe a linha atual */
+static char* proximaLinha(char *p, char *fim, char **linha) {
+    char *nl = (char*) memchr(p, '\n', (size_t)(fim - p));
+    char *termino = nl ? nl : fim;
+    if (termino > p && termino[-1] == '\r') termino[-1] = '\0';
+    *termino = '\0';
+    *linha = p;
+    return nl ? nl + 1 : fim;
+}
+
+/* separarCampos: divide a linha em até max campos separados por ';' (in-place) */
+static int separarCampos(char *linha, char *campos[], int max) {
+    int n = 0;
+    campos[n++] = linha;
+    for (char *p = linha; *p && n < max; ++p) {
+        if (*p == ';') {
+            *p = '\0';
+            campos[n++] = p + 1;
+        }
+    }
+    return n;
+}
+
+/* carregarMansao: lê um arquivo .mansao e monta a árvore num único vetor de salas
+   alocado na arena da sessão. A pista de cada sala é internada na carga, de modo que
+   a visita só lê o campo sala->pista. Retorna a raiz (ou NULL em caso de erro). */
+Sala* carregarMansao(Sessao *sessao, const char *caminho, int *numSalas) {
+    size_t tam;
+    char *buf = lerArquivo(caminho, &tam);
+    if (!buf) return NULL;
+    char *fim = buf + tam;
+
+    /* cota superior do nº de salas: nº de linhas */
+    size_t linhas = 1;
+    for (char *p = buf; (p = (char*) memchr(p, '\n', (size_t)(fim - p))) != NULL; ++p) linhas++;
+    Sala *salas = (Sala*) arenaAlocar(&sessao->arena, linhas * sizeof(Sala));
+
+    int n = 0;
+    int numLinha = 0;
+    char *p = buf;
+    while (p < fim) {
+        char *linha;
+        p = proximaLinha(p, fim, &linha);
+        numLinha++;
+        if (linha[0] == '\0' || linha[0] == '#') continue;
+
+        char *campos[4];
+        int nc = separarCampos(linha, campos, 4);
+        if (nc < 3) {
+            fprintf(stderr, "%s:%d: esperado nome;pai;lado[;pista]\n", caminho, numLinha);
+            free(buf);
+            return NULL;
+        }
+        Sala *sala = &salas[n];
+        strncpy(sala->nome, campos[0], MAX_NOME-1);
+        sala->nome[MAX_NOME-1] = '\0';
+        sala->esq = sala->dir = sala->pai = NULL;
+        sala->pista = (nc > 3 && campos[3][0]) ? internar(&sessao->nomes, campos[3]) : -1;
+
+        char *fimPai;
+        errno = 0;
+        long pai = strtol(campos[1], &fimPai, 10);
+        if (fimPai == campos[1] || *fimPai != '\0' || errno == ERANGE) {
+            fprintf(stderr, "%s:%d: pai nao numerico (%s)\n", caminho, numLinha, campos[1]);
+            free(buf);
+            return NULL;
+        }
+        if (n == 0 ? pai != -1 : (pai < 0 || pai >= n)) {
+            fprintf(stderr, "%s:%d: pai invalido (%ld)\n", caminho, numLinha, pai);
+            free(buf);
+            return NULL;
+        }
+        if (n > 0) {
+            Sala **link = campos[2][0] == 'e' ? &salas[pai].esq : &salas[pai].dir;
+            if (*link || (campos[2][0] != 'e' && campos[2][0] != 'd')) {
+                fprintf(stderr, "%s:%d: lado invalido ou ja ocupado\n", caminho, numLinha);
+                free(buf);
+                return NULL;
+            }
+            *link = sala;
+            sala->pai = &salas[pai];
+        }
+        n++;
+    }
+    free(buf);
+    if (n == 0) {
+        fprintf(stderr, "%s: nenhuma sala definida\n", caminho);
+        return NULL;
+    }
+    if (numSalas) *numSalas = n;
+    sessao->mapa = salas;
+    achatarMansao(sessao);
+    return salas;
+}
+
+/* carregarPistas: lê um arquivo .pistas (pista;suspeito) para a hash da sessão.
+   Retorna quantas associações foram lidas, ou -1 em caso de erro. */
+int carregarPistas(Sessao *sessao, const char *caminho) {
+    size_t tam;
+    char *buf = lerArquivo(caminho, &tam);
+    if (!buf) return -1;
+    char *fim = buf + tam;
+    int n = 0, numLinha = 0;
+    char *p = buf;
+    while (p < fim) {
+        char *linha;
+        p = proximaLinha(p, fim, &linha);
+        numLinha++;
+        if (linha[0] == '\0' || linha[0] == '#') continue;
+        char *campos[2];
+        if (separarCampos(linha, campos, 2) < 2) {
+            fprintf(stderr, "%s:%d: esperado pista;suspeito\n", caminho, numLinha);
+            free(buf);
+            return -1;
+        }
+        inserirNaHash(&sessao->hash, campos[0], campos[1]);
+        n++;
+    }
+    free(buf);
+    return n;
+}
+
+/* gerarMansao: escreve uma mansão aleatória com numSalas salas (cada sala nova ocupa
+   um lado livre sorteado entre as salas existentes) e um arquivo de pistas com
+   numSalas/10 pistas distribuídas entre os suspeitos. Retorna 0 em caso de sucesso. */
+int gerarMansao(int numSalas, const char *arqMansao, const char *arqPistas) {
+    static const char *suspeitos[] = { "Sr. Verde", "Sra. Azul", "Prof. Roxo", "Sra. Rosa", "Sr. Amarelo" };
+    if (numSalas < 1) numSalas = 1;
+    int numPistas = numSalas / 10 > 0 ? numSalas / 10 : 1;
+    FILE *fm = fopen(arqMansao, "w");
+    if (!fm) { perror(arqMansao); return -1; }
+    FILE *fp = fopen(arqPistas, "w");
+    if (!fp) { perror(arqPistas); fclose(fm); return -1; }
+
+    /* lados livres: 2*i = esquerda da sala i, 2*i+1 = direita */
+    int *livres = (int*) malloc(2 * (size_t) numSalas * sizeof(int));
+    if (!livres) { perror("malloc gerarMansao"); fclose(fm); fclose(fp); return -1; }
+    int numLivres = 0;
+
+    fprintf(fm, "# mansao gerada: %d salas\n", numSalas);
+    for (int i = 0; i < numSalas; ++i) {
+        int pai = -1;
+        char lado = 'e';
+        if (i > 0) {
+            int k = (int) prngIntervalo(&aleatorio, (uint32_t) numLivres);
+            int slot = livres[k];
+            livres[k] = livres[--numLivres];
+            pai = slot / 2;
+            lado = (slot % 2) ? 'd' : 'e';
+        }
+        livres[numLivres++] = 2 * i;
+        livres[numLivres++] = 2 * i + 1;
+        if (i == 0) fprintf(fm, "Entrada;-1;e");
+        else fprintf(fm, "Sala %d;%d;%c", i, pai, lado);
+        if (prngIntervalo(&aleatorio, 3) == 0)
+            fprintf(fm, ";pista %d\n", (int) prngIntervalo(&aleatorio, (uint32_t) numPistas));
+        else fputc('\n', fm);
+    }
+    for (int k = 0; k < numPistas; ++k)
+        fprintf(fp, "pista %d;%s\n", k, suspeitos[prngIntervalo(&aleatorio, 5)]);
+
+    free(livres);
+    fclose(fm);
+    fclose(fp);
+    return 0;
+}
+
+_Static_assert(sizeof(NoMansao) == 16 && sizeof(EntradaHash) == 8, "layout do snapshot");
+
+/* escreverSecao: grava tam bytes a partir de *pos e alinha o próximo deslocamento a 8 */
+static int escreverSecao(FILE *f, const void *dados, size_t tam, uint64_t *pos) {
+    static const char zeros[8] = { 0 };
+    size_t pad = (size_t)((8 - (*pos + tam) % 8) % 8);
+    if ((tam && fwrite(dados, 1, tam, f) != tam) || (pad && fwrite(zeros, 1, pad, f) != pad)) return -1;
+    *pos += tam + pad;
+    return 0;
+}
+
+static uint64_t alinhar8(uint64_t x) { return (x + 7) & ~(uint64_t) 7; }
+
+/* salvarSnapshot: grava mansão plana, textos internados (com a tabela de ids), hash
+   pista -> suspeito e pistas coletadas. Retorna 0, ou -1 em caso de erro. */
+int salvarSnapshot(const Sessao *sessao, const char *caminho) {
+    const MansaoPlana *m = &sessao->plana;
+    const Internador *in = &sessao->nomes;
+    const TabelaHash *t = &sessao->hash;
+
+    /* textos num pool único; coletadas pelo percurso em-ordem (ids crescentes) */
+    uint32_t *textoOff = (uint32_t*) malloc((in->numIds > 0 ? (size_t) in->numIds : 1) * sizeof(uint32_t));
+    int *coletadas = (int*) malloc((in->numIds > 0 ? (size_t) in->numIds : 1) * sizeof(int));
+    if (!textoOff || !coletadas) { perror("malloc salvarSnapshot"); exit(1); }
+    uint64_t tamPoolTextos = 0;
+    for (int id = 0; id < in->numIds; ++id) {
+        textoOff[id] = (uint32_t) tamPoolTextos;
+        tamPoolTextos += strlen(in->textos[id]) + 1;
+    }
+    int numColetadas = 0;
+    PistaNode *pilha[AVL_ALTURA_MAX];
+    int topo = 0;
+    for (PistaNode *cur = sessao->pistas; cur || topo > 0; cur = cur->dir) {
+        while (cur) { pilha[topo++] = cur; cur = cur->esq; }
+        cur = pilha[--topo];
+        coletadas[numColetadas++] = cur->id;
+    }
+
+    CabecalhoSnapshot c;
+    memset(&c, 0, sizeof(c));
+    memcpy(c.magica, "DQSNAP", 6);
+    c.versao = SNAPSHOT_VERSAO;
+    c.ordem = 0x01020304u;
+    c.numSalas = m->numSalas;
+    c.tamPoolSalas = m->tamPool;
+    c.numIds = (uint32_t) in->numIds;
+    c.capSlotsNomes = in->numIds > 0 ? in->capSlots : 0;
+    c.tamPoolTextos = (uint32_t) tamPoolTextos;
+    c.capHash = t->capacidade;
+    c.tamHash = t->tamanho;
+    c.numColetadas = (uint32_t) numColetadas;
+    c.offNos = alinhar8(sizeof(c));
+    c.offNomeSala = alinhar8(c.offNos + (uint64_t) c.numSalas * sizeof(NoMansao));
+    c.offPoolSalas = alinhar8(c.offNomeSala + (uint64_t) c.numSalas * sizeof(uint32_t));
+    c.offTextoOff = alinhar8(c.offPoolSalas + c.tamPoolSalas);
+    c.offTextoHash = alinhar8(c.offTextoOff + (uint64_t) c.numIds * sizeof(uint32_t));
+    c.offSlotsNomes = alinhar8(c.offTextoHash + (uint64_t) c.numIds * sizeof(uint32_t));
+    c.offPoolTextos = alinhar8(c.offSlotsNomes + (uint64_t) c.capSlotsNomes * sizeof(int32_t));
+    c.offHash = alinhar8(c.offPoolTextos + c.tamPoolTextos);
+    c.offColetadas = alinhar8(c.offHash + (uint64_t) c.capHash * sizeof(EntradaHash));
+    c.tamArquivo = alinhar8(c.offColetadas + (uint64_t) c.numColetadas * sizeof(int32_t));
+
+    FILE *f = fopen(caminho, "wb");
+    if (!f) { perror(caminho); free(textoOff); free(coletadas); return -1; }
+    uint64_t pos = 0;
+    int erro = escreverSecao(f, &c, sizeof(c), &pos);
+    erro |= escreverSecao(f, m->nos, (size_t) c.numSalas * sizeof(NoMansao), &pos);
+    erro |= escreverSecao(f, m->nome, (size_t) c.numSalas * sizeof(uint32_t), &pos);
+    erro |= escreverSecao(f, m->pool, c.tamPoolSalas, &pos);
+    erro |= escreverSecao(f, textoOff, (size_t) c.numIds * sizeof(uint32_t), &pos);
+    erro |= escreverSecao(f, in->hashes, (size_t) c.numIds * sizeof(uint32_t), &pos);
+    erro |= escreverSecao(f, in->slots, (size_t) c.capSlotsNomes * sizeof(int32_t), &pos);
+    for (int id = 0; id < in->numIds && !erro; ++id) {
+        size_t l = strlen(in->textos[id]) + 1;
+        if (fwrite(in->textos[id], 1, l, f) != l) erro = -1;
+        else pos += l;
+    }
+    erro |= escreverSecao(f, NULL, 0, &pos);
+    erro |= escreverSecao(f, t->slots, (size_t) c.capHash * sizeof(EntradaHash), &pos);
+    erro |= escreverSecao(f, coletadas, (size_t) c.numColetadas * sizeof(int32_t), &pos);
+    if (fclose(f) != 0) erro = -1;
+    free(textoOff);
+    free(coletadas);
+    if (erro || pos != c.tamArquivo) { fprintf(stderr, "%s: erro ao gravar o snapshot\n", caminho); return -1; }
+    return 0;
+}
+
+/* construirPistasOrdenadas: AVL perfeitamente balanceada a partir de ids crescentes, num
+   único bloco da arena (o nó do meio de cada faixa vira a raiz dela; pilha explícita) */
+PistaNode* construirPistasOrdenadas(Arena *a, const int ids[], int n) {
+    if (n <= 0) return NULL;
+    PistaNode *nos = (PistaNode*) arenaAlocar(a, (size_t) n * sizeof(PistaNode));
+    struct { int ini, fim; PistaNode **destino; } pilha[2 * AVL_ALTURA_MAX];
+    PistaNode *raiz = NULL;
+    int topo = 0;
+    pilha[topo].ini = 0; pilha[topo].fim = n; pilha[topo].destino = &raiz; topo++;
+    while (topo > 0) {
+        int ini = pilha[--topo].ini, fim = pilha[topo].fim;
+        PistaNode **destino = pilha[topo].destino;
+        if (ini >= fim) { *destino = NULL; continue; }
+        int meio = ini + (fim - ini) / 2;
+        PistaNode *no = &nos[meio];
+        no->id = ids[meio];
+        no->altura = 0;
+        for (int tam = fim - ini; tam; tam >>= 1) no->altura++; /* floor(log2(tam)) + 1 */
+        *destino = no;
+        pilha[topo].ini = ini; pilha[topo].fim = meio; pilha[topo].destino = &no->esq; topo++;
+        pilha[topo].ini = meio + 1; pilha[topo].fim = fim; pilha[topo].destino = &no->dir; topo++;
+    }
+    return raiz;
+}
+
+/* secaoValida: [off, off + n*tamElem) cabe no arquivo e off está alinhado a 8 */
+static int secaoValida(uint64_t off, uint64_t n, uint64_t tamElem, uint64_t tamArquivo) {
+    return off % 8 == 0 && off <= tamArquivo && n <= (tamArquivo - off) / tamElem;
+}
+
+/* validarSnapshot: confere cabeçalho, limites das seções e todos os índices, para que
+   um arquivo corrompido seja recusado em vez de virar acesso fora dos limites */
+static int validarSnapshot(const unsigned char *base, uint64_t tam) {
+    if (tam < sizeof(CabecalhoSnapshot)) return 0;
+    const CabecalhoSnapshot *c = (const CabecalhoSnapshot*) base;
+    if (memcmp(c->magica, "DQSNAP", 6) != 0 || c->versao != SNAPSHOT_VERSAO ||
+        c->ordem != 0x01020304u || c->tamArquivo != tam)
+        return 0;
+    if (!secaoValida(c->offNos, c->numSalas, sizeof(NoMansao), tam) ||
+        !secaoValida(c->offNomeSala, c->numSalas, sizeof(uint32_t), tam) ||
+        !secaoValida(c->offPoolSalas, c->tamPoolSalas, 1, tam) ||
+        !secaoValida(c->offTextoOff, c->numIds, sizeof(uint32_t), tam) ||
+        !secaoValida(c->offTextoHash, c->numIds, sizeof(uint32_t), tam) ||
+        !secaoValida(c->offSlotsNomes, c->capSlotsNomes, sizeof(int32_t), tam) ||
+        !secaoValida(c->offPoolTextos, c->tamPoolTextos, 1, tam) ||
+        !secaoValida(c->offHash, c->capHash, sizeof(EntradaHash), tam) ||
+        !secaoValida(c->offColetadas, c->numColetadas, sizeof(int32_t), tam))
+        return 0;
+    if (c->numSalas >= SALA_NENHUMA || c->numIds > INT32_MAX / 2) return 0;
+    if ((c->capSlotsNomes & (c->capSlotsNomes - 1)) || (c->numIds && c->capSlotsNomes < 2 * c->numIds)) return 0;
+    if ((c->capHash & (c->capHash - 1)) || c->tamHash > c->capHash) return 0;
+    if ((c->numSalas && (!c->tamPoolSalas || base[c->offPoolSalas + c->tamPoolSalas - 1])) ||
+        (c->numIds && (!c->tamPoolTextos || base[c->offPoolTextos + c->tamPoolTextos - 1])))
+        return 0;
+
+    /* a mansão precisa ser uma árvore em ordem BFS: pai antes do filho e ligações recíprocas */
+    const NoMansao *nos = (const NoMansao*)(base + c->offNos);
+    const uint32_t *nomeSala = (const uint32_t*)(base + c->offNomeSala);
+    for (uint32_t i = 0; i < c->numSalas; ++i) {
+        const NoMansao *no = &nos[i];
+        if ((no->esq != SALA_NENHUMA && (no->esq <= i || no->esq >= c->numSalas || nos[no->esq].pai != i)) ||
+            (no->dir != SALA_NENHUMA && (no->dir <= i || no->dir >= c->numSalas || nos[no->dir].pai != i)) ||
+            (i == 0 ? no->pai != SALA_NENHUMA
+                    : no->pai >= i || (nos[no->pai].esq != i && nos[no->pai].dir != i)) ||
+            no->pista < -1 || no->pista >= (int32_t) c->numIds || nomeSala[i] >= c->tamPoolSalas)
+            return 0;
+    }
+    const uint32_t *textoOff = (const uint32_t*)(base + c->offTextoOff);
+    for (uint32_t id = 0; id < c->numIds; ++id)
+        if (textoOff[id] >= c->tamPoolTextos) return 0;
+    /* as sondagens dependem de haver slots vazios: a ocupação tem de bater com o cabeçalho */
+    const int32_t *slots = (const int32_t*)(base + c->offSlotsNomes);
+    uint32_t ocupados = 0;
+    for (uint32_t i = 0; i < c->capSlotsNomes; ++i) {
+        if (slots[i] < -1 || slots[i] >= (int32_t) c->numIds) return 0;
+        ocupados += slots[i] >= 0;
+    }
+    if (ocupados != c->numIds) return 0;
+    const EntradaHash *hash = (const EntradaHash*)(base + c->offHash);
+    ocupados = 0;
+    for (uint32_t i = 0; i < c->capHash; ++i) {
+        if (hash[i].pista < -1 || hash[i].pista >= (int32_t) c->numIds ||
+            (hash[i].pista >= 0 && (hash[i].suspeito < 0 || hash[i].suspeito >= (int32_t) c->numIds)))
+            return 0;
+        ocupados += hash[i].pista >= 0;
+    }
+    if (ocupados != c->tamHash || (c->capHash && c->tamHash >= c->capHash)) return 0;
+    const int32_t *coletadas = (const int32_t*)(base + c->offColetadas);
+    for (uint32_t i = 0; i < c->numColetadas; ++i)
+        if (coletadas[i] < 0 || coletadas[i] >= (int32_t) c->numIds || (i > 0 && coletadas[i] <= coletadas[i-1]))
+            return 0;
+    return 1;
+}
+
+/* carregarSnapshot: substitui o conteúdo da sessão pelo snapshot, com um único mmap.
+   A mansão, os hashes e a tabela de ids dos textos e a hash pista -> suspeito são usados
+   direto do mapeamento (privado: escritas posteriores não alteram o arquivo); só o vetor
+   id -> texto, a AVL (um bloco) e o índice de suspeitos são montados na arena.
+   Retorna 0, ou -1 em caso de erro. */
+int carregarSnapshot(Sessao *sessao, const char *caminho) {
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) { perror(caminho); return -1; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { perror(caminho); close(fd); return -1; }
+    size_t tam = (size_t) st.st_size;
+    void *mapa = mmap(NULL, tam, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapa == MAP_FAILED) { perror("mmap"); return -1; }
+    unsigned char *base = (unsigned char*) mapa;
+    if (!validarSnapshot(base, tam)) {
+        fprintf(stderr, "%s: snapshot invalido ou de outra versao\n", caminho);
+        munmap(mapa, tam);
+        return -1;
+    }
+    const CabecalhoSnapshot *c = (const CabecalhoSnapshot*) base;
+
+    resetarSessao(sessao);
+    sessao->snapshot = mapa;
+    sessao->tamSnapshot = tam;
+
+    MansaoPlana *m = &sessao->plana;
+    m->nos = (NoMansao*)(base + c->offNos);
+    m->nome = (uint32_t*)(base + c->offNomeSala);
+    m->pool = (char*)(base + c->offPoolSalas);
+    m->tamPool = c->tamPoolSalas;
+    m->numSalas = c->numSalas;
+
+    Internador *in = &sessao->nomes;
+    const uint32_t *textoOff = (const uint32_t*)(base + c->offTextoOff);
+    const char *poolTextos = (const char*)(base + c->offPoolTextos);
+    if (c->numIds > 0) {
+        in->textos = (const char**) arenaAlocar(&sessao->arena, c->numIds * sizeof(char*));
+        for (uint32_t id = 0; id < c->numIds; ++id) in->textos[id] = poolTextos + textoOff[id];
+        in->hashes = (unsigned int*)(base + c->offTextoHash);
+        in->slots = (int*)(base + c->offSlotsNomes);
+        in->capSlots = c->capSlotsNomes;
+    }
+    in->numIds = in->capIds = (int) c->numIds; /* o próximo texto novo realoca na arena */
+
+    TabelaHash *t = &sessao->hash;
+    if (c->capHash > 0) t->slots = (EntradaHash*)(base + c->offHash);
+    t->capacidade = c->capHash;
+    t->tamanho = c->tamHash;
+
+    const int *coletadas = (const int*)(base + c->offColetadas);
+    sessao->pistas = construirPistasOrdenadas(&sessao->arena, coletadas, (int) c->numColetadas);
+    for (uint32_t i = 0; i < c->numColetadas; ++i) {
+        int suspeito = suspeitoDaPista(sessao, coletadas[i]);
+        if (suspeito >= 0) registrarPistaNoIndice(&sessao->indice, suspeito, coletadas[i]);
+        registrarPistaNosTrigramas(&sessao->trigramas, coletadas[i], textoDoId(&sessao->nomes, coletadas[i]));
+    }
+    return 0;
+}
+
+/* mostrarSalaOpcoes: mostra as opções disponíveis na exploração (inclui voltar para usabilidade) */
+void mostrarSalaOpcoes(const MansaoPlana *m, uint32_t atual) {
+    const NoMansao *no = &m->nos[atual];
+    printf("\nOpções de navegação:\n");
+    if (no->esq != SALA_NENHUMA) printf("  e - ir para a esquerda (%s)\n", nomeDaSala(m, no->esq));
+    if (no->dir != SALA_NENHUMA) printf("  d - ir para a direita (%s)\n", nomeDaSala(m, no->dir));
+    if (no->pai != SALA_NENHUMA) printf("  v - voltar para a sala (%s)\n", nomeDaSala(m, no->pai));
+    printf("  s - sair da exploração\n");
+    printf("Escolha (e/d/v/s): ");
+}
+
+/* limpaNewline: remove '\n' deixado por fgets */
+void limpaNewline(char *s) {
+    if (!s) return;
+    size_t l = strlen(s);
+    if (l > 0 && s[l-1] == '\n') s[l-1] = '\0';
+}
+
+/* benchmarkHash: compara a tabela encadeada original (HASH_SIZE baldes) com a tabela
+   aberta Robin Hood, inserindo numPistas chaves e fazendo consultas com e sem acerto. */
+void benchmarkHash(int numPistas) {
+    static const char *suspeitos[] = { "Sr. Verde", "Sra. Azul", "Prof. Roxo", "Sra. Rosa", "Sr. Amarelo" };
+    if (numPistas < 1) numPistas = 1;
+    char (*chaves)[32] = malloc((size_t) numPistas * sizeof(*chaves));
+    char (*ausentes)[32] = malloc((size_t) numPistas * sizeof(*ausentes));
+    if (!chaves || !ausentes) { perror("malloc benchmarkHash"); exit(1); }
+    for (int i = 0; i < numPistas; ++i) {
+        snprintf(chaves[i], sizeof(chaves[i]), "pista %d do caso", i);
+        snprintf(ausentes[i], sizeof(ausentes[i]), "pista %d ausente", i);
+    }
+
+    HashNode *encadeada[HASH_SIZE];
+    for (int i = 0; i < HASH_SIZE; ++i) encadeada[i] = NULL;
+    Arena arena;
+    arenaInicializar(&arena, ARENA_BLOCO);
+    Internador textos;
+    inicializarInternador(&textos, &arena);
+    TabelaHash aberta;
+    inicializarTabela(&aberta, &arena, &textos);
+    long acertos[2] = { 0, 0 };
+    double tempos[2][3];
+
+    for (int impl = 0; impl < 2; ++impl) {
+        clock_t t0 = clock();
+        for (int i = 0; i < numPistas; ++i) {
+            if (impl == 0) inserirNaHashEncadeada(encadeada, chaves[i], suspeitos[i % 5]);
+            else inserirNaHash(&aberta, chaves[i], suspeitos[i % 5]);
+        }
+        clock_t t1 = clock();
+        for (int i = 0; i < numPistas; ++i) {
+            const char *s = impl == 0 ? encontrarSuspeitoEncadeado(encadeada, chaves[i])
+                                      : encontrarSuspeito(&aberta, chaves[i]);
+            if (s) acertos[impl]++;
+        }
+        clock_t t2 = clock();
+        for (int i = 0; i < numPistas; ++i) {
+            const char *s = impl == 0 ? encontrarSuspeitoEncadeado(encadeada, ausentes[i])
+                                      : encontrarSuspeito(&aberta, ausentes[i]);
+            if (s) acertos[impl]++;
+        }
+        clock_t t3 = clock();
+        tempos[impl][0] = (double)(t1 - t0) / CLOCKS_PER_SEC;
+        tempos[impl][1] = (double)(t2 - t1) / CLOCKS_PER_SEC;
+        tempos[impl][2] = (double)(t3 - t2) / CLOCKS_PER_SEC;
+    }
+
+    printf("Benchmark tabela hash (%d pistas)\n", numPistas);
+    printf("%-22s | %14s | %14s | %14s\n", "Implementacao", "insercao ns/op", "acerto ns/op", "falha ns/op");
+    const char *nomes[2] = { "encadeada (101 baldes)", "aberta Robin Hood" };
+    for (int impl = 0; impl < 2; ++impl) {
+        printf("%-22s | %14.1f | %14.1f | %14.1f\n", nomes[impl],
+               tempos[impl][0] * 1e9 / numPistas, tempos[impl][1] * 1e9 / numPistas,
+               tempos[impl][2] * 1e9 / numPistas);
+    }
+    printf("Acertos: encadeada=%ld aberta=%ld | capacidade final da aberta: %u\n",
+           acertos[0], acertos[1], aberta.capacidade);
+
+    liberarHashEncadeada(encadeada);
+    arenaLiberar(&arena);
+    free(chaves);
+    free(ausentes);
+}
+
+/* benchmarkSessoes: executa numSessoes sessões seguidas (hash, mapa e coleta de todas
+   as pistas) reaproveitando a mesma arena; ao final o número de blocos deve ser o
+   mesmo da primeira sessão, sem crescimento nem fragmentação do heap. */
+void benchmarkSessoes(int numSessoes) {
+    if (numSessoes < 1) numSessoes = 1;
+    Sessao sessao;
+    iniciarSessao(&sessao);
+    long pistas = 0;
+    int blocosPrimeira = 0;
+    clock_t inicio = clock();
+    for (int i = 0; i < numSessoes; ++i) {
+        resetarSessao(&sessao);
+        montarMapa(&sessao);
+
+        /* visita todas as salas (varredura linear da mansão plana) coletando as pistas */
+        for (uint32_t j = 0; j < sessao.plana.numSalas; ++j) {
+            int pista = sessao.plana.nos[j].pista;
+            if (pista >= 0) {
+                adicionarPistaId(&sessao, pista);
+                pistas++;
+            }
+        }
+        if (i == 0)
+            for (BlocoArena *b = sessao.arena.primeiro; b; b = b->prox) blocosPrimeira++;
+    }
+    double tempo = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+    int blocos = 0;
+    for (BlocoArena *b = sessao.arena.primeiro; b; b = b->prox) blocos++;
+
+    printf("Benchmark de sessoes: %d sessoes, %ld pistas coletadas em %.3f s (%.0f sessoes/s)\n",
+           numSessoes, pistas, tempo, tempo > 0 ? numSessoes / tempo : 0.0);
+    printf("Blocos da arena: %d apos a primeira sessao, %d ao final\n", blocosPrimeira, blocos);
+    printf("Ranking de suspeitos da ultima sessao:\n");
+    mostrarRanking(&sessao.indice, &sessao.nomes, RANKING_RESUMO_SUSPEITOS, RANKING_RESUMO_PISTAS);
+    encerrarSessao(&sessao);
+}
+
+/* buscarNaBST: referência do benchmark de trechos, percorre a BST inteira com strstr */
+static int buscarNaBST(const PistaNode *root, const Internador *nomes, const char *trecho) {
+    const PistaNode *pilha[AVL_ALTURA_MAX];
+    int topo = 0, n = 0;
+    const PistaNode *cur = root;
+    while (cur || topo > 0) {
+        while (cur) {
+            pilha[topo++] = cur;
+            cur = cur->esq;
+        }
+        cur = pilha[--topo];
+        if (strstr(textoDoId(nomes, cur->id), trecho)) n++;
+        cur = cur->dir;
+    }
+    return n;
+}
+
+/* benchmarkTrechos: coleta numPistas pistas sintéticas e compara, para alguns trechos,
+   o percurso da BST com strstr e a busca pelo índice de trigramas (mesmas contagens) */
+void benchmarkTrechos(int numPistas) {
+    static const char *OBJETOS[] = { "pegada", "bilhete", "fio", "marca", "mancha", "luva",
+                                     "chave", "recibo", "frasco", "botao", "carta", "faca" };
+    static const char *DETALHES[] = { "molhada", "amassado", "rasgado", "de lama", "de tinta",
+                                      "queimado", "de sangue", "dourado", "partido", "sujo" };
+    static const char *LOCAIS[] = { "no tapete", "na escada", "perto da janela", "sob a mesa",
+                                    "no jardim", "atras da porta", "na lareira", "no sotao" };
+    static const char *TRECHOS[] = { "pegada", "de lama", "luva queimado", "no sotao #7",
+                                     "#123456", "veneno", "ta" };
+    const int numObj = sizeof(OBJETOS) / sizeof(OBJETOS[0]);
+    const int numDet = sizeof(DETALHES) / sizeof(DETALHES[0]);
+    const int numLoc = sizeof(LOCAIS) / sizeof(LOCAIS[0]);
+    const int numTrechos = sizeof(TRECHOS) / sizeof(TRECHOS[0]);
+    const int repeticoes = 20;
+    if (numPistas < 1) numPistas = 1;
+
+    Sessao sessao;
+    iniciarSessao(&sessao);
+    char texto[128];
+    clock_t inicio = clock();
+    for (int i = 0; i < numPistas; ++i) {
+        snprintf(texto, sizeof(texto), "%s %s %s #%d",
+                 OBJETOS[prngIntervalo(&aleatorio, numObj)], DETALHES[prngIntervalo(&aleatorio, numDet)],
+                 LOCAIS[prngIntervalo(&aleatorio, numLoc)], i);
+        adicionarPista(&sessao, texto);
+    }
+    double tempoColeta = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+
+    printf("Benchmark de busca por trecho (%d pistas coletadas em %.3f s, %u trigramas)\n",
+           numPistas, tempoColeta, sessao.trigramas.numListas);
+    printf("%-16s | %10s | %14s | %15s | %8s\n", "Trecho", "pistas", "BST us/busca",
+           "indice us/busca", "ganho");
+    for (int t = 0; t < numTrechos; ++t) {
+        int nBst = 0, nIdx = 0;
+        clock_t t0 = clock();
+        for (int k = 0; k < repeticoes; ++k) nBst = buscarNaBST(sessao.pistas, &sessao.nomes, TRECHOS[t]);
+        clock_t t1 = clock();
+        for (int k = 0; k < repeticoes; ++k) {
+            int *ids;
+            nIdx = buscarPistasPorTrecho(&sessao, TRECHOS[t], &ids);
+            free(ids);
+        }
+        clock_t t2 = clock();
+        double bst = (double)(t1 - t0) / CLOCKS_PER_SEC * 1e6 / repeticoes;
+        double idx = (double)(t2 - t1) / CLOCKS_PER_SEC * 1e6 / repeticoes;
+        printf("%-16s | %10d | %14.1f | %15.1f | %7.1fx%s\n", TRECHOS[t], nIdx, bst, idx,
+               idx > 0 ? bst / idx : 0.0, nBst == nIdx ? "" : "  DIVERGENTE");
+    }
+    encerrarSessao(&sessao);
+}
+
+/* Semente decimal: só dígitos e cabendo em 64 bits; senão 0 (e *semente intacta) */
+static int lerSemente(const char *texto, uint64_t *semente) {
+    if (!*texto || strspn(texto, "0123456789") != strlen(texto)) return 0;
+    errno = 0;
+    unsigned long long valor = strtoull(texto, NULL, 10);
+    if (errno == ERANGE || valor > UINT64_MAX) return 0;
+    *semente = (uint64_t) valor;
+    return 1;
+}
+
+/* suspender: grava o snapshot pedido em --salvar e informa o tempo gasto */
+static void suspender(const Sessao *sessao, const char *caminho) {
+    double inicio = relogioParede();
+    if (salvarSnapshot(sessao, caminho) == 0)
+        printf("Investigação salva em %s (%.1f ms)\n", caminho, (relogioParede() - inicio) * 1e3);
+}
+
+/* ---------- MAIN (montagem do hash, mapa e loop principal) ---------- */
+int main(int argc, char *argv[]) {
+    /* gerador global (passeios, mansões geradas, detetives); --semente o fixa */
+    prngSemear(&aleatorio, prngSementeDoRelogio());
+#ifndef NDEBUG
+    /* exceto em --gerar-phf, que é justamente como se conserta uma tabela desatualizada */
+    if (!(argc > 1 && strcmp(argv[1], "--gerar-phf") == 0) && conferirTabelasPerfeitas() > 0) {
+        fprintf(stderr, "Tabelas estaticas desatualizadas: rode --gerar-phf e substitua o bloco gerado\n");
+        return 1;
+    }
+#endif
+
+    if (argc > 1 && strcmp(argv[1], "--bench-hash") == 0) {
+        benchmarkHash(argc > 2 ? atoi(argv[2]) : 20000);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--bench-sessoes") == 0) {
+        benchmarkSessoes(argc > 2 ? atoi(argv[2]) : 10000);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--bench-trechos") == 0) {
+        benchmarkTrechos(argc > 2 ? atoi(argv[2]) : 200000);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--gerar-phf") == 0) {
+        gerarTabelasPerfeitas();
+        return 0;
+    }
+
+    if (argc > 4 && strcmp(argv[1], "--gerar-mansao") == 0) {
+        uint64_t semente;
+        if (argc > 5) {
+            if (!lerSemente(argv[5], &semente)) {
+                fprintf(stderr, "Semente inválida: %s\nUso: %s --gerar-mansao numSalas arqMansao arqPistas [semente]\n",
+                        argv[5], argv[0]);
+                return 1;
+            }
+            prngSemear(&aleatorio, semente);
+        }
+        return gerarMansao(atoi(argv[2]), argv[3], argv[4]) == 0 ? 0 : 1;
+    }
+
+    /* opções em pares: --mansao, --pistas, --roteiro, --passeio, --repetir, --planejar,
+       --detetives, --salvar, --retomar, --semente, --buscar */
+    const char *arqMansao = NULL, *arqPistas = NULL, *arqRoteiro = NULL;
+    const char *arqSalvar = NULL, *arqRetomar = NULL, *trecho = NULL;
+    long numPassos = -1, repeticoes = 1;
+    int planejar = 0, detetives = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--mansao") == 0) arqMansao = argv[i+1];
+        else if (strcmp(argv[i], "--pistas") == 0) arqPistas = argv[i+1];
+        else if (strcmp(argv[i], "--roteiro") == 0) arqRoteiro = argv[i+1];
+        else if (strcmp(argv[i], "--passeio") == 0) numPassos = atol(argv[i+1]);
+        else if (strcmp(argv[i], "--repetir") == 0) repeticoes = atol(argv[i+1]);
+        else if (strcmp(argv[i], "--planejar") == 0) planejar = atoi(argv[i+1]);
+        else if (strcmp(argv[i], "--detetives") == 0) detetives = atoi(argv[i+1]);
+        else if (strcmp(argv[i], "--salvar") == 0) arqSalvar = argv[i+1];
+        else if (strcmp(argv[i], "--retomar") == 0) arqRetomar = argv[i+1];
+        else if (strcmp(argv[i], "--semente") == 0) {
+            uint64_t semente;
+            if (!lerSemente(argv[i+1], &semente)) {
+                fprintf(stderr, "Semente inválida: %s\nUso: %s ... --semente N (só dígitos)\n", argv[i+1], argv[0]);
+                return 1;
+            }
+            prngSemear(&aleatorio, semente);
+        }
+        else if (strcmp(argv[i], "--buscar") == 0) trecho = argv[i+1];
+        else { fprintf(stderr, "Opção desconhecida: %s\n", argv[i]); return 1; }
+    }
+
+    /* sessão: arena, tabela hash vazia e BST de pistas coletadas (inicialmente vazia) */
+    Sessao sessao;
+    iniciarSessao(&sessao);
+
+    if (arqRetomar) {
+        /* investigação suspensa: mansão, hash e pistas coletadas voltam do snapshot */
+        double inicio = relogioParede();
+        if (carregarSnapshot(&sessao, arqRetomar) != 0) {
+            encerrarSessao(&sessao);
+            return 1;
+        }
+        printf("Investigação retomada: %u salas, %d textos em %.1f ms\n",
+               sessao.plana.numSalas, sessao.nomes.numIds, (relogioParede() - inicio) * 1e3);
+    } else if (arqMansao) {
+        /* mansão e pistas de arquivo; as associações vêm antes para a hash estar pronta */
+        clock_t inicio = clock();
+        int numPistas = 0, numSalas = 0;
+        if (arqPistas) {
+            numPistas = carregarPistas(&sessao, arqPistas);
+        }
+        if (numPistas < 0 || !carregarMansao(&sessao, arqMansao, &numSalas)) {
+            encerrarSessao(&sessao);
+            return 1;
+        }
+        printf("Mansão carregada: %d salas, %d associações em %.3f s\n",
+               numSalas, numPistas, (double)(clock() - inicio) / CLOCKS_PER_SEC);
+    } else {
+        /* monta mapa fixo; as associações pista -> suspeito vêm da tabela estática */
+        montarMapa(&sessao);
+    }
+
+    if (planejar) {
+        RotaSuspeito *rotas;
+        clock_t inicio = clock();
+        int n = planejarRotas(&sessao, &rotas);
+        printf("Rotas mínimas a partir da Entrada (%d pistas distintas por suspeito), %.3f s:\n",
+               PISTAS_PARA_CONDENAR, (double)(clock() - inicio) / CLOCKS_PER_SEC);
+        mostrarRotas(rotas, n, &sessao.nomes);
+        liberarRotas(rotas, n);
+        encerrarSessao(&sessao);
+        return 0;
+    }
+
+    if (detetives > 0) {
+        benchmarkDetetives(&sessao, detetives, numPassos >= 0 ? numPassos : 1000000);
+        if (trecho) mostrarBuscaPorTrecho(&sessao, trecho);
+        if (arqSalvar) suspender(&sessao, arqSalvar);
+        encerrarSessao(&sessao);
+        return 0;
+    }
+
+    if (arqRoteiro || numPassos >= 0) {
+        /* modo sem interação: coleta silenciosa e relatório de vazão */
+        size_t tam = 0;
+        char *cmds = arqRoteiro ? lerArquivo(arqRoteiro, &tam) : gerarPasseio(&sessao.plana, numPassos);
+        if (!cmds) { encerrarSessao(&sessao); return 1; }
+        if (!arqRoteiro) tam = strlen(cmds);
+        ResultadoRoteiro r = { 0 };
+        for (long k = 0; k < repeticoes; ++k)
+            explorarRoteiro(&sessao, cmds, tam, &r);
+        mostrarResultadoRoteiro(&r, &sessao);
+        if (trecho) mostrarBuscaPorTrecho(&sessao, trecho);
+        if (arqSalvar) suspender(&sessao, arqSalvar);
+        free(cmds);
+        encerrarSessao(&sessao);
+        return 0;
+    }
+
+    /* iniciar exploração a partir da raiz */
+    printf("Bem-vindo(a) a Detective Quest - Explore a mansão e colete pistas!\n");
+    printf("Navegue pelas salas e ao terminar faremos o julgamento.\n");
+
+    explorarSalas(&sessao);
+    if (arqSalvar) suspender(&sessao, arqSalvar);
+
+    /* Fim da exploração: listamos pistas e pedimos acusação */
+    printf("\n--- Pistas coletadas (ordenadas) ---\n");
+    if (!sessao.pistas) {
+        printf("Nenhuma pista coletada.\n");
+    } else {
+        listarPistasBST(sessao.pistas, &sessao.nomes);
+    }
+    if (trecho) mostrarBuscaPorTrecho(&sessao, trecho);
+
+    verificarSuspeitoFinal(&sessao);
+
+    /* liberar memória: salas, BST e hash saem juntas com a arena da sessão */
+    encerrarSessao(&sessao);
+
+    printf("\nObrigado por jogar Detective Quest!\n");
+
+    return 0;
+}
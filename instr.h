@@ -0,0 +1,210 @@
+/*
+  instr.h
+  Instrumentação leve para os caminhos quentes dos programas: contadores, cronômetros
+  em nanossegundos e histogramas (baldes log2), por thread e sem travas no caminho
+  quente. Sem -DINSTRUMENTAR as macros não geram código algum.
+  - INSTR_CONTAR(nome) / INSTR_SOMAR(nome, n): contador
+  - INSTR_HISTOGRAMA(nome, valor): distribuição de um valor (ex.: comparações, sondagens)
+  - INSTR_TEMPO_INICIO(var, nome) ... INSTR_TEMPO_FIM(var): cronômetro do trecho entre as
+    duas macros (no mesmo escopo); o tempo entra no histograma do nome, em ns
+  - Ao sair, as estatísticas vão para INSTR_SAIDA (arquivo .csv => CSV, senão JSON)
+    ou, sem essa variável de ambiente, para stderr em JSON.
+  Os nomes são literais; sites diferentes com o mesmo nome somam na mesma métrica.
+  Só cabeçalho (funções static inline): gcc ... -DINSTRUMENTAR
+  O cronômetro usa CLOCK_MONOTONIC: quem inclui define _POSIX_C_SOURCE >= 199309L antes
+  dos #include (em -std=c11).
+*/
+
+#ifndef INSTR_H
+#define INSTR_H
+
+#ifdef INSTRUMENTAR
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define INSTR_MAX 64    /* métricas distintas por programa */
+#define INSTR_BALDES 65 /* balde b: valores em [2^(b-1), 2^b); balde 0: valor 0 */
+
+#define INSTR_CONTADOR 0
+#define INSTR_VALOR 1
+#define INSTR_TEMPO_NS 2
+
+/* Bloco de uma thread: só ela escreve; a soma entre threads é feita no despejo final */
+typedef struct InstrBloco {
+    uint64_t contagem[INSTR_MAX];
+    uint64_t soma[INSTR_MAX];
+    uint64_t maximo[INSTR_MAX];
+    uint64_t baldes[INSTR_MAX][INSTR_BALDES];
+    struct InstrBloco *prox;
+} InstrBloco;
+
+typedef struct {
+    int id;
+    uint64_t inicio;
+} InstrCronometro;
+
+static const char *instrNomes[INSTR_MAX];
+static int instrTipos[INSTR_MAX];
+static _Atomic int instrNumMetricas;
+static atomic_flag instrTrava = ATOMIC_FLAG_INIT; /* só no registro de um nome novo */
+static _Atomic(InstrBloco*) instrBlocos;          /* blocos de todas as threads */
+static _Thread_local InstrBloco *instrLocal;
+
+static inline uint64_t instrAgoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts); /* imune a ajustes do relógio de parede */
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+static void instrDespejar(void);
+
+/* id da métrica nome (registrada na primeira chamada de cada site; cache em *id) */
+static inline int instrId(_Atomic int *id, const char *nome, int tipo) {
+    int v = atomic_load_explicit(id, memory_order_acquire);
+    if (v >= 0) return v;
+    while (atomic_flag_test_and_set_explicit(&instrTrava, memory_order_acquire)) {}
+    int n = atomic_load_explicit(&instrNumMetricas, memory_order_relaxed);
+    for (v = 0; v < n && strcmp(instrNomes[v], nome) != 0; ++v) {}
+    if (v == n) {
+        if (n == 0) atexit(instrDespejar);
+        if (n == INSTR_MAX) {
+            v = INSTR_MAX - 1; /* excedente soma na última métrica */
+        } else {
+            instrNomes[n] = nome;
+            instrTipos[n] = tipo;
+            atomic_store_explicit(&instrNumMetricas, n + 1, memory_order_release);
+        }
+    }
+    atomic_flag_clear_explicit(&instrTrava, memory_order_release);
+    atomic_store_explicit(id, v, memory_order_release);
+    return v;
+}
+
+static inline InstrBloco* instrBloco(void) {
+    InstrBloco *b = instrLocal;
+    if (b) return b;
+    b = (InstrBloco*) calloc(1, sizeof(InstrBloco));
+    if (!b) {
+        perror("calloc instrumentacao");
+        exit(1);
+    }
+    b->prox = atomic_load(&instrBlocos);
+    while (!atomic_compare_exchange_weak(&instrBlocos, &b->prox, b)) {}
+    return instrLocal = b;
+}
+
+static inline void instrAmostrar(int id, uint64_t valor) {
+    InstrBloco *b = instrBloco();
+    b->contagem[id]++;
+    b->soma[id] += valor;
+    if (valor > b->maximo[id]) b->maximo[id] = valor;
+    b->baldes[id][valor ? 64 - __builtin_clzll(valor) : 0]++;
+}
+
+static inline void instrSomar(int id, uint64_t n) {
+    InstrBloco *b = instrBloco();
+    b->contagem[id]++;
+    b->soma[id] += n;
+}
+
+static inline InstrCronometro instrIniciar(int id) {
+    InstrCronometro c = { id, instrAgoraNs() };
+    return c;
+}
+
+static inline void instrParar(const InstrCronometro *c) {
+    instrAmostrar(c->id, instrAgoraNs() - c->inicio);
+}
+
+/* limite superior do balde onde cai a fração q das amostras */
+static uint64_t instrQuantil(const uint64_t *baldes, uint64_t total, double q) {
+    uint64_t alvo = (uint64_t) (q * (double) total), acumulado = 0;
+    for (int b = 0; b < INSTR_BALDES; ++b) {
+        acumulado += baldes[b];
+        if (acumulado > alvo) return b == 0 ? 0 : (b == 64 ? UINT64_MAX : (1ull << b) - 1);
+    }
+    return 0;
+}
+
+/* atexit: soma os blocos das threads e grava JSON ou CSV */
+static void instrDespejar(void) {
+    static const char *TIPOS[3] = { "contador", "valor", "tempo_ns" };
+    const char *caminho = getenv("INSTR_SAIDA");
+    FILE *f = caminho ? fopen(caminho, "w") : stderr;
+    if (!f) {
+        perror(caminho);
+        return;
+    }
+    size_t tam = strlen(caminho ? caminho : "");
+    int csv = tam >= 4 && strcmp(caminho + tam - 4, ".csv") == 0;
+    int n = atomic_load(&instrNumMetricas);
+    if (csv) fprintf(f, "nome,tipo,amostras,soma,max,p50,p99\n");
+    else fprintf(f, "{\"metricas\": [");
+    for (int m = 0; m < n; ++m) {
+        uint64_t contagem = 0, soma = 0, maximo = 0, baldes[INSTR_BALDES] = { 0 };
+        for (InstrBloco *b = atomic_load(&instrBlocos); b; b = b->prox) {
+            contagem += b->contagem[m];
+            soma += b->soma[m];
+            if (b->maximo[m] > maximo) maximo = b->maximo[m];
+            for (int k = 0; k < INSTR_BALDES; ++k) baldes[k] += b->baldes[m][k];
+        }
+        int hist = instrTipos[m] != INSTR_CONTADOR;
+        uint64_t p50 = hist ? instrQuantil(baldes, contagem, 0.5) : 0;
+        uint64_t p99 = hist ? instrQuantil(baldes, contagem, 0.99) : 0;
+        if (p50 > maximo) p50 = maximo; /* o balde só dá um limite superior */
+        if (p99 > maximo) p99 = maximo;
+        if (csv) {
+            fprintf(f, "%s,%s,%llu,%llu,%llu,%llu,%llu\n", instrNomes[m], TIPOS[instrTipos[m]],
+                    (unsigned long long) contagem, (unsigned long long) soma, (unsigned long long) maximo,
+                    (unsigned long long) p50, (unsigned long long) p99);
+            continue;
+        }
+        fprintf(f, "%s\n  {\"nome\": \"%s\", \"tipo\": \"%s\", \"amostras\": %llu, \"soma\": %llu",
+                m ? "," : "", instrNomes[m], TIPOS[instrTipos[m]], (unsigned long long) contagem,
+                (unsigned long long) soma);
+        if (hist) {
+            fprintf(f, ", \"max\": %llu, \"p50\": %llu, \"p99\": %llu, \"baldes\": {", (unsigned long long) maximo,
+                    (unsigned long long) p50, (unsigned long long) p99);
+            for (int k = 0, primeiro = 1; k < INSTR_BALDES; ++k) {
+                if (!baldes[k]) continue;
+                fprintf(f, "%s\"%d\": %llu", primeiro ? "" : ", ", k, (unsigned long long) baldes[k]);
+                primeiro = 0;
+            }
+            fprintf(f, "}");
+        }
+        fprintf(f, "}");
+    }
+    if (!csv) fprintf(f, "\n]}\n");
+    if (f != stderr) fclose(f);
+}
+
+#define INSTR_SOMAR(nome, n) do { \
+        static _Atomic int instrId_ = -1; \
+        instrSomar(instrId(&instrId_, nome, INSTR_CONTADOR), (uint64_t) (n)); \
+    } while (0)
+#define INSTR_CONTAR(nome) INSTR_SOMAR(nome, 1)
+#define INSTR_HISTOGRAMA(nome, valor) do { \
+        static _Atomic int instrId_ = -1; \
+        instrAmostrar(instrId(&instrId_, nome, INSTR_VALOR), (uint64_t) (valor)); \
+    } while (0)
+#define INSTR_TEMPO_INICIO(var, nome) \
+    static _Atomic int var##Id_ = -1; \
+    InstrCronometro var = instrIniciar(instrId(&var##Id_, nome, INSTR_TEMPO_NS))
+#define INSTR_TEMPO_FIM(var) instrParar(&var)
+
+#else /* sem INSTRUMENTAR: nada é compilado */
+
+#define INSTR_SOMAR(nome, n) ((void) 0)
+#define INSTR_CONTAR(nome) ((void) 0)
+#define INSTR_HISTOGRAMA(nome, valor) ((void) 0)
+#define INSTR_TEMPO_INICIO(var, nome) ((void) 0)
+#define INSTR_TEMPO_FIM(var) ((void) 0)
+
+#endif /* INSTRUMENTAR */
+
+#endif /* INSTR_H */
@@ -1,282 +1,2241 @@
-/*
-  pecas.c
-  Gerenciador de peças: fila circular (5) + pilha (3)
-  - Peças: nome ('I','O','T','L') e id único (int)
-  - Ações: jogar (dequeue), reservar (fila->pilha), usar (pop pilha),
-           trocar frente da fila com topo da pilha, troca múltipla (3),
-           exibição do estado e encerramento.
-  - A fila é mantida cheia gerando novas peças automaticamente quando uma peça
-    é removida ou enviada para a pilha (quando aplicável).
-  - Compilar: gcc -o pecas pecas.c -std=c11
-*/
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <time.h>
-
-#define FILA_CAP 5
-#define PILHA_CAP 3
-
-/* --- Estrutura que representa uma peça --- */
-typedef struct {
-    char nome; /* 'I', 'O', 'T', 'L' */
-    int id;    /* id único incremental */
-} Peca;
-
-/* --- Fila circular --- */
-typedef struct {
-    Peca dados[FILA_CAP];
-    int inicio;  /* índice do elemento da frente */
-    int tamanho; /* número de elementos presentes */
-} Fila;
-
-/* --- Pilha simples --- */
-typedef struct {
-    Peca dados[PILHA_CAP];
-    int topo; /* índice do topo: -1 quando vazia */
-} Pilha;
-
-/* --- Variáveis globais auxiliares --- */
-int proximoId = 0; /* gera ids únicos */
-
-/* --- Prototipos --- */
-Peca gerarPeca();
-void inicializarFila(Fila *f);
-void inicializarPilha(Pilha *p);
-int filaVazia(Fila *f);
-int filaCheia(Fila *f);
-int pilhaVazia(Pilha *p);
-int pilhaCheia(Pilha *p);
-void enqueue(Fila *f, Peca px);
-Peca dequeue(Fila *f);
-void push(Pilha *p, Peca px);
-Peca pop(Pilha *p);
-void exibirEstado(const Fila *f, const Pilha *p);
-void jogarPeca(Fila *f);
-void reservarPeca(Fila *f, Pilha *p);
-void usarPecaReservada(Pilha *p);
-void trocarFrenteTopo(Fila *f, Pilha *p);
-void trocarTres(Fila *f, Pilha *p);
-void mostrarMenu();
-void pausa();
-
-/* --- Implementações --- */
-
-/* Gera uma peça com nome aleatório ('I','O','T','L') e id incremental */
-Peca gerarPeca() {
-    Peca p;
-    int r = rand() % 4;
-    switch (r) {
-        case 0: p.nome = 'I'; break;
-        case 1: p.nome = 'O'; break;
-        case 2: p.nome = 'T'; break;
-        default: p.nome = 'L'; break;
-    }
-    p.id = proximoId++;
-    return p;
-}
-
-/* Inicializa fila: coloca tamanho = 0 e inicio = 0
-   Em seguida, enfileira FILA_CAP peças geradas para ficar cheia inicialmente */
-void inicializarFila(Fila *f) {
-    f->inicio = 0;
-    f->tamanho = 0;
-    for (int i = 0; i < FILA_CAP; ++i) {
-        enqueue(f, gerarPeca());
-    }
-}
-
-/* Inicializa pilha: topo = -1 (vazia) */
-void inicializarPilha(Pilha *p) {
-    p->topo = -1;
-}
-
-/* Verificações de estado */
-int filaVazia(Fila *f) {
-    return (f->tamanho == 0);
-}
-int filaCheia(Fila *f) {
-    return (f->tamanho == FILA_CAP);
-}
-int pilhaVazia(Pilha *p) {
-    return (p->topo == -1);
-}
-int pilhaCheia(Pilha *p) {
-    return (p->topo == PILHA_CAP - 1);
-}
-
-/* Enfileira na fila circular (assume que não está cheia em uso regular) */
-void enqueue(Fila *f, Peca px) {
-    if (filaCheia(f)) {
-        /* caso de segurança: se cheia, descarta (não deveria ocorrer se usado corretamente) */
-        return;
-    }
-    int pos = (f->inicio + f->tamanho) % FILA_CAP;
-    f->dados[pos] = px;
-    f->tamanho++;
-}
-
-/* Desenfileira a frente e retorna a peça; assume que há elemento */
-Peca dequeue(Fila *f) {
-    Peca ret = { '?', -1 };
-    if (filaVazia(f)) return ret;
-    ret = f->dados[f->inicio];
-    f->inicio = (f->inicio + 1) % FILA_CAP;
-    f->tamanho--;
-    return ret;
-}
-
-/* Push na pilha */
-void push(Pilha *p, Peca px) {
-    if (pilhaCheia(p)) return;
-    p->topo++;
-    p->dados[p->topo] = px;
-}
-
-/* Pop da pilha */
-Peca pop(Pilha *p) {
-    Peca ret = { '?', -1 };
-    if (pilhaVazia(p)) return ret;
-    ret = p->dados[p->topo];
-    p->topo--;
-    return ret;
-}
-
-/* Exibe uma peça no formato [X id] */
-void exibirPeca(const Peca *px) {
-    if (px->id < 0) {
-        printf("[   ] ");
-    } else {
-        printf("[%c %d] ", px->nome, px->id);
-    }
-}
-
-/* Exibe estado atual: fila e pilha formatadas */
-void exibirEstado(const Fila *f, const Pilha *p) {
-    printf("\nEstado atual:\n\n");
-    /* Fila */
-    printf("Fila de peças\t");
-    if (filaVazia((Fila*)f)) {
-        printf("(vazia)\n");
-    } else {
-        for (int i = 0; i < f->tamanho; ++i) {
-            int idx = (f->inicio + i) % FILA_CAP;
-            exibirPeca(&f->dados[idx]);
-        }
-        printf("\n");
-    }
-    /* Pilha */
-    printf("Pilha de reserva\t(Topo -> base): ");
-    if (pilhaVazia((Pilha*)p)) {
-        printf("(vazia)\n");
-    } else {
-        for (int i = p->topo; i >= 0; --i) {
-            exibirPeca(&p->dados[i]);
-        }
-        printf("\n");
-    }
-    printf("\n");
-}
-
-/* Jogar peça: remove da frente da fila (dequeue) e gera nova peça para manter fila cheia */
-void jogarPeca(Fila *f) {
-    if (filaVazia(f)) {
-        printf("Fila vazia: nada para jogar.\n");
-        return;
-    }
-    Peca jogada = dequeue(f);
-    printf("Jogou a peça: [%c %d]\n", jogada.nome, jogada.id);
-    /* Gerar nova peça e enfileirar (manter fila cheia quando possível) */
-    Peca nova = gerarPeca();
-    enqueue(f, nova);
-}
-
-/* Reservar peça: move a peça da frente da fila para o topo da pilha, se pilha tiver espaço.
-   Após mover, gera nova peça para manter fila cheia */
-void reservarPeca(Fila *f, Pilha *p) {
-    if (filaVazia(f)) {
-        printf("Fila vazia: nada para reservar.\n");
-        return;
-    }
-    if (pilhaCheia(p)) {
-        printf("Pilha cheia: não é possível reservar (pilha com capacidade máxima).\n");
-        return;
-    }
-    Peca mover = dequeue(f);
-    push(p, mover);
-    printf("Reservou a peça [%c %d] para a pilha (topo).\n", mover.nome, mover.id);
-    /* Gerar nova peça para manter fila cheia */
-    Peca nova = gerarPeca();
-    enqueue(f, nova);
-}
-
-/* Usar peça reservada (pop da pilha) */
-void usarPecaReservada(Pilha *p) {
-    if (pilhaVazia(p)) {
-        printf("Pilha vazia: nenhuma peça reservada para usar.\n");
-        return;
-    }
-    Peca usada = pop(p);
-    printf("Usou a peça reservada: [%c %d]\n", usada.nome, usada.id);
-    /* NÃO geramos nova peça aqui; somente remoções/transferências da fila geram novas peças. */
-}
-
-/* Trocar peça da frente da fila com o topo da pilha */
-void trocarFrenteTopo(Fila *f, Pilha *p) {
-    if (filaVazia(f)) {
-        printf("Fila vazia: nada para trocar.\n");
-        return;
-    }
-    if (pilhaVazia(p)) {
-        printf("Pilha vazia: nada no topo para trocar.\n");
-        return;
-    }
-    int idxFrente = f->inicio;
-    Peca tmp = f->dados[idxFrente];
-    f->dados[idxFrente] = p->dados[p->topo];
-    p->dados[p->topo] = tmp;
-    printf("Troca realizada entre frente da fila e topo da pilha.\n");
-    /* Observação: não geramos novas peças aqui porque não ocorreu remoção da fila. */
-}
-
-/* Troca múltipla: alterna as três primeiras da fila com as três da pilha
-   Condição: fila deve ter pelo menos 3 peças e pilha ter pelo menos 3 peças */
-void trocarTres(Fila *f, Pilha *p) {
-    if (f->tamanho < 3) {
-        printf("A fila não tem 3 peças disponíveis para a troca.\n");
-        return;
-    }
-    if (p->topo < 2) {
-        printf("A pilha não tem 3 peças (pelo menos) para a troca.\n");
-        return;
-    }
-    /* Captura as três primeiras da fila (ordem: frente -> frente+1 -> frente+2) */
-    Peca q0 = f->dados[f->inicio];
-    Peca q1 = f->dados[(f->inicio + 1) % FILA_CAP];
-    Peca q2 = f->dados[(f->inicio + 2) % FILA_CAP];
-
-    /* Captura as três do topo da pilha: top (s0), top-1 (s1), top-2 (s2) */
-    Peca s0 = p->dados[p->topo];
-    Peca s1 = p->dados[p->topo - 1];
-    Peca s2 = p->dados[p->topo - 2];
-
-    /* Coloca os elementos da pilha (top->down) nas três primeiras posições da fila */
-    f->dados[f->inicio] = s0;
-    f->dados[(f->inicio + 1) % FILA_CAP] = s1;
-    f->dados[(f->inicio + 2) % FILA_CAP] = s2;
-
-    /* Coloca os elementos da fila (frente->...) na pilha de forma que
-       novo topo seja q2, depois q1, depois q0 (conforme exemplo de saída) */
-    p->dados[p->topo] = q2;
-    p->dados[p->topo - 1] = q1;
-    p->dados[p->topo - 2] = q0;
-
-    printf("Troca realizada entre os 3 primeiros da fila e as 3 peças do topo da pilha.\n");
-}
-
-/* Menu e interação */
-void mostrarMenu() {
-    printf("Opções disponíveis:\n\n");
-    printf("Código\tAção\n");
-    printf("1\tJogar peça da frente da fila\n");
-    printf("2\tEnv
+/*
+  pecas.c
+  Gerenciador de peças: fila circular (5) + pilha (3), capacidades definidas em execução
+  - Peças: nome ('I','O','T','L') e id único (int)
+  - Ações: jogar (dequeue), reservar (fila->pilha), usar (pop pilha),
+           trocar frente da fila com topo da pilha, troca múltipla (3),
+           exibição do estado e encerramento.
+  - A fila é mantida cheia gerando novas peças automaticamente quando uma peça
+    é removida ou enviada para a pilha (quando aplicável).
+  - Opcionalmente (--alimentador), uma thread produtora gera as peças num anel sem travas
+    (SPSC, ou MPMC para vários jogadores) e jogar/reservar só retiram peças prontas do anel.
+  - Números aleatórios vêm de prng.h (xoshiro256**, semente explícita via semearPecas).
+  - Compilar: gcc -o pecas pecas.c -std=c11 -pthread (com -DINSTRUMENTAR, contadores de
+    instr.h nas operações da fila, gravados ao sair)
+  - Jogo: ./pecas [--semente N] [--alimentador]; benchmarks: ./pecas --bench-fila, --bench-alimentador,
+    --bench-gerador, --bench-simulador, --bench-sessoes e --bench-solver (argumentos em main)
+*/
+
+#define _POSIX_C_SOURCE 200809L /* clock_gettime em -std=c11 */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "instr.h"
+#include "prng.h"
+#include "saida.h"
+
+#define FILA_CAP 5  /* capacidade padrão (lógica) da fila */
+#define PILHA_CAP 3 /* capacidade padrão da pilha */
+#define LINHA_CACHE 64      /* separa os contadores de produtor e consumidor */
+#define LOTE_PRODUCAO 32    /* peças publicadas de uma vez pela thread produtora */
+#define ANEL_CAP 1024       /* capacidade padrão do anel do alimentador */
+#define MAX_PRODUTORES 8
+
+/* distribuições do gerador de peças */
+#define DIST_UNIFORME 0   /* cada peça sorteada independentemente */
+#define DIST_SACO 1       /* saco com uma peça de cada tipo, embaralhado a cada 4 */
+#define DIST_SACO_DUPLO 2 /* saco com duas de cada tipo, embaralhado a cada 8 */
+
+/* resultados do núcleo das ações (sem E/S) */
+#define ACAO_OK 0
+#define ACAO_FILA_VAZIA 1
+#define ACAO_PILHA_CHEIA 2
+#define ACAO_PILHA_VAZIA 3
+#define ACAO_FILA_CURTA 4  /* menos de 3 peças na fila */
+#define ACAO_PILHA_CURTA 5 /* menos de 3 peças na pilha */
+#define NUM_ACOES 5        /* 'j' jogar, 'r' reservar, 'u' usar, 't' trocar, 'm' troca múltipla */
+#define HISTORICO_CAP 64   /* versões guardadas para desfazer/refazer */
+#define SOLVER_PROF_MAX 64 /* limite de profundidade do solver (ações) */
+#define SOLVER_BITS_TT 20  /* tabela de transposição padrão: 2^20 entradas por thread */
+
+/* --- Estrutura que representa uma peça --- */
+typedef struct {
+    char nome; /* 'I', 'O', 'T', 'L' */
+    int id;    /* id único incremental */
+} Peca;
+
+/* --- Fila circular ---
+   Capacidade física potência de 2 (posição = contador & mascara, sem %), escolhida em
+   tempo de execução. cabeca e cauda só crescem; o tamanho é cauda - cabeca, em
+   aritmética sem sinal, que continua correta quando os contadores dão a volta. */
+typedef struct {
+    Peca *dados;
+    unsigned int mascara; /* capacidade física - 1 */
+    unsigned int limite;  /* nº máximo de peças (pode ser menor que a capacidade física) */
+    unsigned int cabeca;  /* contador da frente */
+    unsigned int cauda;   /* contador do fim */
+} Fila;
+
+/* --- Pilha simples (capacidade escolhida em tempo de execução) --- */
+typedef struct {
+    Peca *dados;
+    int capacidade;
+    int topo; /* índice do topo: -1 quando vazia */
+} Pilha;
+
+/* --- Gerador de peças: Prng (prng.h) com estado próprio (uma instância por sessão ou
+   thread) e semente explícita, para execuções reproduzíveis --- */
+typedef struct {
+    Prng prng;
+    int distribuicao;
+    uint64_t bits;          /* uniforme: sorteio de 64 bits ainda não consumido (2 bits/peça) */
+    int bitsRestantes;
+    unsigned char saco[8];  /* saco embaralhado (índices em TIPOS_PECA) */
+    int posSaco, tamSaco;
+} GeradorPecas;
+
+/* --- Resultado de uma simulação sem interação --- */
+typedef struct {
+    long acoes;                /* comandos consumidos */
+    long aplicadas[NUM_ACOES]; /* ações bem-sucedidas, na ordem de CODIGOS_ACAO */
+    long recusadas;            /* ações impossíveis no estado (fila/pilha vazia, cheia ou curta) */
+    long desconhecidas;        /* caracteres que não são ações */
+    long violacoes;            /* invariantes quebradas (verificação ligada); deve ser 0 */
+    uint64_t hashFila;         /* hash do estado final (frente -> fim) */
+    uint64_t hashPilha;        /* hash do estado final (topo -> base) */
+    double segundos;
+} ResultadoSimulacao;
+
+/* --- Histórico de ações: cada versão é um delta de tamanho fixo com o que a ação
+   tirou ou pôs, o bastante para desfazê-la ou refazê-la em O(1) sem copiar a fila
+   nem a pilha. Os deltas ficam num anel; quando ele enche, a versão mais antiga
+   deixa de ser restaurável. Versões são contadores crescentes (como na Fila). --- */
+typedef struct {
+    char acao;     /* letra de CODIGOS_ACAO */
+    char repostas; /* peças enfileiradas na reposição depois da ação (0 ou 1) */
+    Peca peca;     /* jogada, reservada ou usada */
+    Peca reposta;
+} Delta;
+
+typedef struct {
+    Delta *deltas;
+    unsigned int mascara; /* capacidade - 1 (potência de 2) */
+    unsigned int base;    /* versão mais antiga ainda restaurável */
+    unsigned int atual;   /* versão corrente: deltas [base, atual) podem ser desfeitos */
+    unsigned int fim;     /* deltas [atual, fim) podem ser refeitos */
+} Historico;
+
+/* --- Peça compacta: tipo (índice em TIPOS_PECA) nos 2 bits baixos, id nos 30 de cima.
+   O valor com todos os bits em 1 marca posição vazia, logo ids vão de 0 a 2^30 - 2. --- */
+typedef uint32_t PecaCompacta;
+#define PECA_VAZIA 0xFFFFFFFFu
+#define ID_COMPACTO_MAX 0x3FFFFFFE
+
+/* --- Sessão compacta: fila (5) + pilha (3) em 8 posições de 32 bits, 32 bytes.
+   Posição k fica em w[k / 2], bits 32 * (k % 2). Posições 0..4: fila, frente primeiro;
+   5..7: pilha, topo primeiro. As posições vazias ficam sempre no fim de cada parte,
+   então os tamanhos não precisam ser guardados. --- */
+typedef struct {
+    uint64_t w[4];
+} SessaoCompacta;
+
+/* --- Muitas sessões em estrutura de arrays: coluna k guarda a palavra w[k] de todas as
+   sessões, para atualizações em lote percorrerem memória contígua --- */
+typedef struct {
+    size_t n;
+    uint64_t *w[4];
+} SessoesCompactas;
+
+/* --- Solução do solver: menor sequência de ações cujas peças jogadas (por jogar ou
+   usar) formam exatamente o padrão de tipos pedido --- */
+typedef struct {
+    char acoes[SOLVER_PROF_MAX + 1]; /* letras de CODIGOS_ACAO; vazia se não achou */
+    int movimentos;                  /* -1 se não há solução até a profundidade máxima */
+    int profundidade;                /* último limite buscado por inteiro */
+    long long nos;
+    double segundos;
+    size_t memoria; /* bytes das tabelas de transposição e do fluxo de peças */
+} SolucaoPecas;
+
+/* --- Anel SPSC (um produtor, um consumidor), sem travas ---
+   Cada lado publica só o seu contador (release) e guarda uma cópia do contador do outro
+   lado, relida (acquire) apenas quando o anel parece cheio/vazio. Os dois contadores
+   ficam em linhas de cache separadas para não haver falso compartilhamento. */
+typedef struct {
+    _Alignas(LINHA_CACHE) _Atomic unsigned int cauda; /* escrito só pelo produtor */
+    unsigned int cabecaVista;                          /* cópia do produtor */
+    _Alignas(LINHA_CACHE) _Atomic unsigned int cabeca; /* escrito só pelo consumidor */
+    unsigned int caudaVista;                           /* cópia do consumidor */
+    _Alignas(LINHA_CACHE) Peca *dados;
+    unsigned int mascara;
+} AnelSPSC;
+
+/* --- Anel MPMC (vários produtores e consumidores), sem travas ---
+   Cada célula tem um número de sequência que diz de quem é a vez: seq == pos livre
+   para o produtor da posição pos, seq == pos + 1 pronta para o consumidor. */
+typedef struct {
+    _Atomic unsigned int seq;
+    Peca peca;
+} CelulaMPMC;
+
+typedef struct {
+    _Alignas(LINHA_CACHE) _Atomic unsigned int cauda;
+    _Alignas(LINHA_CACHE) _Atomic unsigned int cabeca;
+    _Alignas(LINHA_CACHE) CelulaMPMC *celulas;
+    unsigned int mascara;
+} AnelMPMC;
+
+/* --- Alimentador: threads produtoras mantendo o anel abastecido --- */
+struct AlimentadorPecas;
+typedef struct {
+    struct AlimentadorPecas *al;
+    GeradorPecas gerador; /* próprio da thread: rand() não é seguro entre threads */
+    pthread_t thread;
+} ProdutorPecas;
+
+typedef struct AlimentadorPecas {
+    AnelSPSC spsc;
+    AnelMPMC mpmc;
+    int multi;                  /* 0 = SPSC (um jogador), 1 = MPMC (vários) */
+    _Atomic int proximoId;      /* ids reservados em lotes pelos produtores */
+    _Atomic int parar;
+    _Atomic int dormindo;       /* produtoras esperando espaço no anel */
+    pthread_mutex_t trava;      /* só para dormir e acordar; o anel não usa */
+    pthread_cond_t espaco;      /* sinalizada quando o jogador retira peças */
+    int numProdutores;
+    ProdutorPecas produtores[MAX_PRODUTORES];
+} AlimentadorPecas;
+
+/* --- Fila de índice com %, capacidade fixa (versão original, referência do benchmark) --- */
+typedef struct {
+    Peca dados[FILA_CAP];
+    int inicio;  /* índice do elemento da frente */
+    int tamanho; /* número de elementos presentes */
+} FilaModulo;
+
+/* --- Variáveis globais auxiliares --- */
+int proximoId = 0; /* gera ids únicos */
+static const char TIPOS_PECA[4] = { 'I', 'O', 'T', 'L' };
+static const char CODIGOS_ACAO[NUM_ACOES] = { 'j', 'r', 'u', 't', 'm' };
+GeradorPecas geradorPadrao; /* usado por gerarPeca() */
+int geradorPadraoPronto = 0; /* semeado a partir de origemSementes no primeiro uso */
+Prng origemSementes; /* sementes de gerarPeca e das produtoras; fixada por semearPecas */
+int origemSementesPronta = 0; /* sem semearPecas, vem do relógio */
+AlimentadorPecas *alimentador = NULL; /* se ativo, jogar/reservar repõem a fila a partir dele */
+Historico *historico = NULL; /* se ativo, as ações do menu são registradas para desfazer */
+
+/* --- Prototipos --- */
+Peca gerarPeca();
+void semearPecas(uint64_t semente);
+void semearGerador(GeradorPecas *g, uint64_t semente, int distribuicao);
+uint64_t proximoAleatorio(GeradorPecas *g);
+char sortearTipo(GeradorPecas *g);
+void gerarPecas(GeradorPecas *g, Peca *saida, size_t n, int primeiroId);
+void benchmarkGerador(long long numPecas);
+void criarFila(Fila *f, unsigned int limite);
+void liberarFila(Fila *f);
+void criarPilha(Pilha *p, int capacidade);
+void liberarPilha(Pilha *p);
+void inicializarFila(Fila *f);
+void inicializarPilha(Pilha *p);
+int filaVazia(Fila *f);
+int filaCheia(Fila *f);
+unsigned int tamanhoFila(const Fila *f);
+Peca* pecaDaFila(const Fila *f, unsigned int i);
+int pilhaVazia(Pilha *p);
+int pilhaCheia(Pilha *p);
+void enqueue(Fila *f, Peca px);
+Peca dequeue(Fila *f);
+unsigned int enqueueVarios(Fila *f, const Peca *px, unsigned int n);
+unsigned int dequeueVarios(Fila *f, Peca *saida, unsigned int n);
+void benchmarkFila(long numOps);
+void criarAnelSPSC(AnelSPSC *a, unsigned int capacidade);
+unsigned int publicarSPSC(AnelSPSC *a, const Peca *px, unsigned int n);
+unsigned int consumirSPSC(AnelSPSC *a, Peca *saida, unsigned int n);
+void criarAnelMPMC(AnelMPMC *a, unsigned int capacidade);
+int publicarMPMC(AnelMPMC *a, Peca px);
+int consumirMPMC(AnelMPMC *a, Peca *saida);
+void iniciarAlimentador(AlimentadorPecas *al, int multi, int numProdutores, unsigned int capacidade);
+void pararAlimentador(AlimentadorPecas *al);
+unsigned int retirarPecas(AlimentadorPecas *al, Peca *saida, unsigned int n);
+void reabastecerFila(Fila *f);
+void benchmarkAlimentador(long jogadas, int numJogadores);
+void push(Pilha *p, Peca px);
+Peca pop(Pilha *p);
+void exibirEstado(const Fila *f, const Pilha *p);
+int acaoJogar(Fila *f, Peca *jogada);
+int acaoReservar(Fila *f, Pilha *p, Peca *movida);
+int acaoUsar(Pilha *p, Peca *usada);
+int acaoTrocar(Fila *f, Pilha *p);
+int acaoTrocarTres(Fila *f, Pilha *p);
+void criarHistorico(Historico *h, unsigned int capacidade);
+void liberarHistorico(Historico *h);
+void limparHistorico(Historico *h);
+void registrarAcao(Historico *h, char acao, Peca peca, int repostas, Peca reposta);
+int historicoDesfazer(Historico *h, Fila *f, Pilha *p);
+int historicoRefazer(Historico *h, Fila *f, Pilha *p);
+int voltarParaVersao(Historico *h, Fila *f, Pilha *p, unsigned int versao);
+void desfazerAcao(Fila *f, Pilha *p);
+void refazerAcao(Fila *f, Pilha *p);
+void jogarPeca(Fila *f);
+void reservarPeca(Fila *f, Pilha *p);
+void usarPecaReservada(Pilha *p);
+void trocarFrenteTopo(Fila *f, Pilha *p);
+void trocarTres(Fila *f, Pilha *p);
+char* gerarAcoes(GeradorPecas *g, size_t n);
+PecaCompacta compactarPeca(Peca px);
+Peca expandirPeca(PecaCompacta c);
+void compactarSessao(const Fila *f, const Pilha *p, SessaoCompacta *s);
+void expandirSessao(const SessaoCompacta *s, Fila *f, Pilha *p);
+int compactaJogar(SessaoCompacta *s, PecaCompacta *jogada);
+int compactaReservar(SessaoCompacta *s);
+int compactaUsar(SessaoCompacta *s, PecaCompacta *usada);
+int compactaTrocar(SessaoCompacta *s);
+int compactaTrocarTres(SessaoCompacta *s);
+int compactaRepor(SessaoCompacta *s, PecaCompacta nova);
+void criarSessoes(SessoesCompactas *ss, size_t n);
+void liberarSessoes(SessoesCompactas *ss);
+long aplicarEmLote(SessoesCompactas *ss, const char *acoes, GeradorPecas *g, int *proximoIdLote);
+void benchmarkSessoes(size_t numSessoes, int rodadas);
+int resolverPadrao(uint64_t semente, int distribuicao, const char *padrao, int profundidadeMax, int numThreads,
+                   unsigned int bitsTabela, SolucaoPecas *sol);
+int conferirSolucao(uint64_t semente, int distribuicao, const char *padrao, const char *acoes);
+void benchmarkSolver(uint64_t semente, const char *padrao, int numThreads);
+void simularAcoes(Fila *f, Pilha *p, GeradorPecas *g, int *proximoId, const char *acoes, size_t n,
+                  int verificar, ResultadoSimulacao *r);
+void benchmarkSimulador(long numAcoes, uint64_t semente);
+void mostrarMenu();
+void pausa();
+
+/* --- Implementações --- */
+
+/* Fixa a semente do jogo: mesma semente, mesmas peças (gerarPeca e produtoras) */
+void semearPecas(uint64_t semente) {
+    prngSemear(&origemSementes, semente);
+    origemSementesPronta = 1;
+    geradorPadraoPronto = 0;
+}
+
+static Prng* origemDasSementes(void) {
+    if (!origemSementesPronta) semearPecas(prngSementeDoRelogio());
+    return &origemSementes;
+}
+
+/* Gera uma peça com nome aleatório ('I','O','T','L') e id incremental */
+Peca gerarPeca() {
+    Peca p;
+    if (!geradorPadraoPronto) {
+        semearGerador(&geradorPadrao, prngProximo(origemDasSementes()), DIST_UNIFORME);
+        geradorPadraoPronto = 1;
+    }
+    p.nome = sortearTipo(&geradorPadrao);
+    p.id = proximoId++;
+    return p;
+}
+
+/* Semeia o gerador (a semente é expandida por prngSemear) */
+void semearGerador(GeradorPecas *g, uint64_t semente, int distribuicao) {
+    prngSemear(&g->prng, semente);
+    g->distribuicao = distribuicao;
+    g->bits = 0;
+    g->bitsRestantes = 0;
+    g->tamSaco = distribuicao == DIST_SACO_DUPLO ? (int) sizeof(g->saco) : 4;
+    g->posSaco = g->tamSaco; /* saco vazio: embaralha no primeiro sorteio */
+    for (int i = 0; i < (int) sizeof(g->saco); ++i) g->saco[i] = (unsigned char)(i & 3);
+}
+
+/* Próximo valor de 64 bits do gerador */
+uint64_t proximoAleatorio(GeradorPecas *g) {
+    return prngProximo(&g->prng);
+}
+
+/* Embaralha o saco (Fisher-Yates) com um único sorteio de 64 bits: cada índice é a parte
+   alta de x * (i + 1) e a parte baixa continua como fração para o próximo. Cada uma das
+   tamSaco! ordens recebe floor ou ceil de 2^64 / tamSaco! valores de x: viés relativo
+   <= 8! / 2^64 < 2^-48 */
+static void embaralharSaco(GeradorPecas *g) {
+    uint64_t x = proximoAleatorio(g);
+    for (int i = g->tamSaco - 1; i > 0; --i) {
+        uint64_t m = (uint64_t)(i + 1);
+        /* parte alta do produto de 128 bits; m <= 8 não estoura as parciais */
+        int j = (int)(((x >> 32) * m + (((x & 0xFFFFFFFFull) * m) >> 32)) >> 32);
+        x *= m;
+        unsigned char tmp = g->saco[i];
+        g->saco[i] = g->saco[j];
+        g->saco[j] = tmp;
+    }
+    g->posSaco = 0;
+}
+
+/* Sorteia o tipo da próxima peça segundo a distribuição do gerador. No modo uniforme
+   cada sorteio de 64 bits rende 32 peças. */
+char sortearTipo(GeradorPecas *g) {
+    if (g->distribuicao == DIST_UNIFORME) {
+        if (g->bitsRestantes == 0) {
+            g->bits = proximoAleatorio(g);
+            g->bitsRestantes = 32;
+        }
+        char tipo = TIPOS_PECA[g->bits & 3];
+        g->bits >>= 2;
+        g->bitsRestantes--;
+        return tipo;
+    }
+    if (g->posSaco == g->tamSaco) embaralharSaco(g);
+    return TIPOS_PECA[g->saco[g->posSaco++]];
+}
+
+/* Gera n peças com ids primeiroId, primeiroId + 1, ...; produz exatamente a mesma sequência
+   de n chamadas a sortearTipo. No modo uniforme, o miolo trata 32 peças por sorteio num
+   laço sem desvios que o compilador vetoriza. */
+void gerarPecas(GeradorPecas *g, Peca *saida, size_t n, int primeiroId) {
+    size_t i = 0;
+    if (g->distribuicao == DIST_UNIFORME) {
+        for (; i < n && g->bitsRestantes > 0; ++i) {
+            saida[i].nome = sortearTipo(g);
+            saida[i].id = primeiroId + (int) i;
+        }
+        for (; i + 32 <= n; i += 32) {
+            uint64_t r = proximoAleatorio(g);
+            Peca *bloco = saida + i;
+            int id = primeiroId + (int) i;
+            for (int k = 0; k < 32; ++k) {
+                bloco[k].nome = TIPOS_PECA[(r >> (2 * k)) & 3];
+                bloco[k].id = id + k;
+            }
+        }
+    } else {
+        /* sacos: termina o saco atual e depois copia sacos inteiros recém-embaralhados */
+        for (; i < n && g->posSaco < g->tamSaco; ++i) {
+            saida[i].nome = sortearTipo(g);
+            saida[i].id = primeiroId + (int) i;
+        }
+        for (; i + (size_t) g->tamSaco <= n; i += (size_t) g->tamSaco) {
+            embaralharSaco(g);
+            for (int k = 0; k < g->tamSaco; ++k) {
+                saida[i + k].nome = TIPOS_PECA[g->saco[k]];
+                saida[i + k].id = primeiroId + (int) i + k;
+            }
+            g->posSaco = g->tamSaco;
+        }
+    }
+    for (; i < n; ++i) {
+        saida[i].nome = sortearTipo(g);
+        saida[i].id = primeiroId + (int) i;
+    }
+}
+
+/* Benchmark: numPecas peças por distribuição (em blocos de 4096), contra o rand() % 4
+   original; confere também a reprodutibilidade e a justiça dos sacos */
+void benchmarkGerador(long long numPecas) {
+    enum { BLOCO = 4096 };
+    static Peca buf[BLOCO];
+    static const char *nomesDist[3] = { "xoshiro uniforme", "saco de 4", "saco duplo (8)" };
+    if (numPecas < BLOCO) numPecas = BLOCO;
+    printf("Benchmark do gerador (%lld peças)\n", numPecas);
+    printf("%-18s | %14s | %9s | %s\n", "Gerador", "pecas/s", "tempo (s)", "I/O/T/L");
+
+    long long cont[4] = { 0, 0, 0, 0 };
+    long long soma = 0; /* consome a saída para o compilador não descartar a geração */
+    clock_t t0 = clock();
+    long long base = numPecas / 16; /* rand() é bem mais lento: mede 1/16 e extrapola */
+    for (long long i = 0; i < base; ++i) cont[rand() % 4]++;
+    double tempo = (double)(clock() - t0) / CLOCKS_PER_SEC;
+    printf("%-18s | %14.0f | %9.3f | %lld/%lld/%lld/%lld\n", "rand() % 4", tempo > 0 ? base / tempo : 0.0,
+           tempo, cont[0], cont[1], cont[2], cont[3]);
+
+    for (int d = DIST_UNIFORME; d <= DIST_SACO_DUPLO; ++d) {
+        GeradorPecas g;
+        semearGerador(&g, 12345, d);
+        long long maxDesvio = 0; /* maior |nI - nL| visto ao fim de cada bloco */
+        t0 = clock();
+        for (long long feito = 0; feito < numPecas; feito += BLOCO) {
+            size_t n = (size_t)(numPecas - feito < BLOCO ? numPecas - feito : BLOCO);
+            gerarPecas(&g, buf, n, (int) feito);
+            soma += buf[n - 1].nome;
+        }
+        tempo = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+        /* contagem exata numa amostra menor, para a coluna de justiça */
+        GeradorPecas amostra;
+        semearGerador(&amostra, 12345, d);
+        long long c[4] = { 0, 0, 0, 0 };
+        for (int k = 0; k < 1000000; ++k) {
+            char t = sortearTipo(&amostra);
+            c[t == 'I' ? 0 : t == 'O' ? 1 : t == 'T' ? 2 : 3]++;
+            long long desvio = c[0] > c[3] ? c[0] - c[3] : c[3] - c[0];
+            if (desvio > maxDesvio) maxDesvio = desvio;
+        }
+        printf("%-18s | %14.0f | %9.3f | %lld/%lld/%lld/%lld em 1e6 (desvio max I-L %lld)\n",
+               nomesDist[d], tempo > 0 ? numPecas / tempo : 0.0, tempo, c[0], c[1], c[2], c[3], maxDesvio);
+    }
+
+    /* mesma semente => mesma sequência, em lote ou peça a peça */
+    GeradorPecas a, b;
+    int iguais = 1;
+    for (int d = DIST_UNIFORME; d <= DIST_SACO_DUPLO && iguais; ++d) {
+        semearGerador(&a, 2024, d);
+        semearGerador(&b, 2024, d);
+        gerarPecas(&a, buf, 1000, 0);
+        for (int k = 0; k < 1000; ++k) iguais &= sortearTipo(&b) == buf[k].nome;
+    }
+    printf("Reproduzivel (lote == peca a peca, mesma semente): %s (checksum %lld)\n",
+           iguais ? "sim" : "NAO", soma);
+}
+
+/* Cria fila vazia para até limite peças; a capacidade física é a menor potência de 2
+   que comporta o limite */
+void criarFila(Fila *f, unsigned int limite) {
+    unsigned int cap = 1;
+    if (limite < 1) limite = 1;
+    while (cap < limite) cap <<= 1;
+    f->dados = (Peca*) malloc(cap * sizeof(Peca));
+    if (!f->dados) {
+        perror("malloc fila");
+        exit(1);
+    }
+    f->mascara = cap - 1;
+    f->limite = limite;
+    f->cabeca = f->cauda = 0;
+}
+
+void liberarFila(Fila *f) {
+    free(f->dados);
+    f->dados = NULL;
+    f->limite = 0;
+    f->cabeca = f->cauda = 0;
+}
+
+/* Cria pilha vazia com a capacidade pedida */
+void criarPilha(Pilha *p, int capacidade) {
+    if (capacidade < 1) capacidade = 1;
+    p->dados = (Peca*) malloc(capacidade * sizeof(Peca));
+    if (!p->dados) {
+        perror("malloc pilha");
+        exit(1);
+    }
+    p->capacidade = capacidade;
+    p->topo = -1;
+}
+
+void liberarPilha(Pilha *p) {
+    free(p->dados);
+    p->dados = NULL;
+    p->capacidade = 0;
+    p->topo = -1;
+}
+
+/* Inicializa fila com a capacidade padrão (FILA_CAP)
+   Em seguida, enfileira FILA_CAP peças geradas para ficar cheia inicialmente */
+void inicializarFila(Fila *f) {
+    criarFila(f, FILA_CAP);
+    for (int i = 0; i < FILA_CAP; ++i) {
+        enqueue(f, gerarPeca());
+    }
+}
+
+/* Inicializa pilha com a capacidade padrão (PILHA_CAP): topo = -1 (vazia) */
+void inicializarPilha(Pilha *p) {
+    criarPilha(p, PILHA_CAP);
+}
+
+/* Verificações de estado */
+int filaVazia(Fila *f) {
+    return (f->cauda == f->cabeca);
+}
+int filaCheia(Fila *f) {
+    return (f->cauda - f->cabeca == f->limite);
+}
+unsigned int tamanhoFila(const Fila *f) {
+    return f->cauda - f->cabeca;
+}
+/* i-ésima peça a partir da frente (0 = frente) */
+Peca* pecaDaFila(const Fila *f, unsigned int i) {
+    return &f->dados[(f->cabeca + i) & f->mascara];
+}
+int pilhaVazia(Pilha *p) {
+    return (p->topo == -1);
+}
+int pilhaCheia(Pilha *p) {
+    return (p->topo == p->capacidade - 1);
+}
+
+/* Enfileira na fila circular (assume que não está cheia em uso regular) */
+void enqueue(Fila *f, Peca px) {
+    if (filaCheia(f)) {
+        /* caso de segurança: se cheia, descarta (não deveria ocorrer se usado corretamente) */
+        INSTR_CONTAR("pecas.enqueue.descartadas");
+        return;
+    }
+    INSTR_CONTAR("pecas.enqueue");
+    f->dados[f->cauda & f->mascara] = px;
+    f->cauda++;
+}
+
+/* Desenfileira a frente e retorna a peça; assume que há elemento */
+Peca dequeue(Fila *f) {
+    Peca ret = { '?', -1 };
+    if (filaVazia(f)) {
+        INSTR_CONTAR("pecas.dequeue.vazia");
+        return ret;
+    }
+    INSTR_CONTAR("pecas.dequeue");
+    ret = f->dados[f->cabeca & f->mascara];
+    f->cabeca++;
+    return ret;
+}
+
+/* Enfileira até n peças de uma vez (no máximo o espaço livre), copiando em no máximo
+   dois trechos contíguos; retorna quantas entraram */
+unsigned int enqueueVarios(Fila *f, const Peca *px, unsigned int n) {
+    unsigned int livre = f->limite - tamanhoFila(f);
+    if (n > livre) n = livre;
+    unsigned int pos = f->cauda & f->mascara;
+    unsigned int ateOFim = f->mascara + 1 - pos;
+    unsigned int primeiro = n < ateOFim ? n : ateOFim;
+    memcpy(&f->dados[pos], px, primeiro * sizeof(Peca));
+    memcpy(f->dados, px + primeiro, (n - primeiro) * sizeof(Peca));
+    f->cauda += n;
+    INSTR_HISTOGRAMA("pecas.enqueueVarios.lote", n);
+    return n;
+}
+
+/* Desenfileira até n peças de uma vez para saida; retorna quantas saíram */
+unsigned int dequeueVarios(Fila *f, Peca *saida, unsigned int n) {
+    unsigned int tam = tamanhoFila(f);
+    if (n > tam) n = tam;
+    unsigned int pos = f->cabeca & f->mascara;
+    unsigned int ateOFim = f->mascara + 1 - pos;
+    unsigned int primeiro = n < ateOFim ? n : ateOFim;
+    memcpy(saida, &f->dados[pos], primeiro * sizeof(Peca));
+    memcpy(saida + primeiro, f->dados, (n - primeiro) * sizeof(Peca));
+    f->cabeca += n;
+    INSTR_HISTOGRAMA("pecas.dequeueVarios.lote", n);
+    return n;
+}
+
+/* Operações da fila original (índice com %), mantidas para o benchmark */
+static void enqueueModulo(FilaModulo *f, Peca px) {
+    if (f->tamanho == FILA_CAP) return;
+    f->dados[(f->inicio + f->tamanho) % FILA_CAP] = px;
+    f->tamanho++;
+}
+
+static Peca dequeueModulo(FilaModulo *f) {
+    Peca ret = { '?', -1 };
+    if (f->tamanho == 0) return ret;
+    ret = f->dados[f->inicio];
+    f->inicio = (f->inicio + 1) % FILA_CAP;
+    f->tamanho--;
+    return ret;
+}
+
+/* Benchmark: numOps pares enqueue/dequeue com a fila mantida cheia (como no jogo) na
+   versão original com %, na fila com máscara e na fila com operações em lote */
+void benchmarkFila(long numOps) {
+    enum { LOTE = 64 };
+    if (numOps < LOTE) numOps = LOTE;
+    const char *nomes[3] = { "original (%)", "mascara", "lote de 64 (mascara)" };
+    double tempos[3];
+    long soma[3] = { 0, 0, 0 }; /* consome os ids para o compilador não descartar o laço */
+
+    FilaModulo fm = { .inicio = 0, .tamanho = 0 };
+    Fila f, grande;
+    criarFila(&f, FILA_CAP);
+    criarFila(&grande, 2 * LOTE);
+    Peca lote[LOTE];
+    for (int i = 0; i < LOTE; ++i) lote[i] = (Peca) { "IOTL"[i & 3], i };
+    for (int i = 0; i < FILA_CAP; ++i) { enqueueModulo(&fm, lote[i]); enqueue(&f, lote[i]); }
+    enqueueVarios(&grande, lote, LOTE);
+
+    clock_t t0 = clock();
+    for (long i = 0; i < numOps; ++i) {
+        Peca px = dequeueModulo(&fm);
+        soma[0] += px.id;
+        px.id = (int) i;
+        enqueueModulo(&fm, px);
+    }
+    clock_t t1 = clock();
+    for (long i = 0; i < numOps; ++i) {
+        Peca px = dequeue(&f);
+        soma[1] += px.id;
+        px.id = (int) i;
+        enqueue(&f, px);
+    }
+    clock_t t2 = clock();
+    for (long i = 0; i < numOps; i += LOTE) {
+        Peca saida[LOTE];
+        unsigned int n = dequeueVarios(&grande, saida, LOTE);
+        for (unsigned int k = 0; k < n; ++k) soma[2] += saida[k].id;
+        enqueueVarios(&grande, saida, n);
+    }
+    clock_t t3 = clock();
+    tempos[0] = (double)(t1 - t0) / CLOCKS_PER_SEC;
+    tempos[1] = (double)(t2 - t1) / CLOCKS_PER_SEC;
+    tempos[2] = (double)(t3 - t2) / CLOCKS_PER_SEC;
+
+    printf("Benchmark da fila (%ld pares enqueue/dequeue)\n", numOps);
+    printf("%-22s | %16s | %10s\n", "Implementacao", "ops/s", "tempo (s)");
+    for (int k = 0; k < 3; ++k)
+        printf("%-22s | %16.0f | %10.3f\n", nomes[k],
+               tempos[k] > 0 ? 2.0 * numOps / tempos[k] : 0.0, tempos[k]);
+    printf("(checksum %ld %ld %ld)\n", soma[0], soma[1], soma[2]);
+    liberarFila(&f);
+    liberarFila(&grande);
+}
+
+/* Push na pilha */
+void push(Pilha *p, Peca px) {
+    if (pilhaCheia(p)) return;
+    p->topo++;
+    p->dados[p->topo] = px;
+}
+
+/* Pop da pilha */
+Peca pop(Pilha *p) {
+    Peca ret = { '?', -1 };
+    if (pilhaVazia(p)) return ret;
+    ret = p->dados[p->topo];
+    p->topo--;
+    return ret;
+}
+
+/* Exibe uma peça no formato [X id] */
+void exibirPeca(const Peca *px) {
+    if (px->id < 0) {
+        saidaStr("[   ] ");
+    } else {
+        saidaCar('[');
+        saidaCar(px->nome);
+        saidaCar(' ');
+        saidaInt(px->id);
+        saidaStr("] ");
+    }
+}
+
+/* Exibe estado atual: fila e pilha formatadas (registro "estado" com --registros) */
+void exibirEstado(const Fila *f, const Pilha *p) {
+    if (saidaRegistros(SAIDA_NORMAL)) {
+        saidaRegistro("estado");
+        saidaCampoInt("fila", tamanhoFila(f));
+        saidaCampoInt("pilha", p->topo + 1);
+        saidaFimRegistro();
+    }
+    if (!saidaTexto(SAIDA_NORMAL)) return;
+    saidaStr("\nEstado atual:\n\n");
+    /* Fila */
+    saidaStr("Fila de peças\t");
+    if (filaVazia((Fila*)f)) {
+        saidaStr("(vazia)\n");
+    } else {
+        for (unsigned int i = 0; i < tamanhoFila(f); ++i) {
+            exibirPeca(pecaDaFila(f, i));
+        }
+        saidaCar('\n');
+    }
+    /* Pilha */
+    saidaStr("Pilha de reserva\t(Topo -> base): ");
+    if (pilhaVazia((Pilha*)p)) {
+        saidaStr("(vazia)\n");
+    } else {
+        for (int i = p->topo; i >= 0; --i) {
+            exibirPeca(&p->dados[i]);
+        }
+        saidaCar('\n');
+    }
+    saidaCar('\n');
+}
+
+/* Núcleo das ações: alteram fila e pilha sem imprimir nem repor peças, e retornam ACAO_*.
+   São usados pelas versões interativas abaixo e pelo simulador sem interação. */
+int acaoJogar(Fila *f, Peca *jogada) {
+    if (filaVazia(f)) return ACAO_FILA_VAZIA;
+    *jogada = dequeue(f);
+    return ACAO_OK;
+}
+
+int acaoReservar(Fila *f, Pilha *p, Peca *movida) {
+    if (filaVazia(f)) return ACAO_FILA_VAZIA;
+    if (pilhaCheia(p)) return ACAO_PILHA_CHEIA;
+    *movida = dequeue(f);
+    push(p, *movida);
+    return ACAO_OK;
+}
+
+int acaoUsar(Pilha *p, Peca *usada) {
+    if (pilhaVazia(p)) return ACAO_PILHA_VAZIA;
+    *usada = pop(p);
+    return ACAO_OK;
+}
+
+int acaoTrocar(Fila *f, Pilha *p) {
+    if (filaVazia(f)) return ACAO_FILA_VAZIA;
+    if (pilhaVazia(p)) return ACAO_PILHA_VAZIA;
+    Peca *frente = pecaDaFila(f, 0);
+    Peca tmp = *frente;
+    *frente = p->dados[p->topo];
+    p->dados[p->topo] = tmp;
+    return ACAO_OK;
+}
+
+/* Troca múltipla: os 3 primeiros da fila passam para a pilha (novo topo = terceiro da fila)
+   e os 3 do topo da pilha vão para a frente da fila (topo primeiro) */
+int acaoTrocarTres(Fila *f, Pilha *p) {
+    if (tamanhoFila(f) < 3) return ACAO_FILA_CURTA;
+    if (p->topo < 2) return ACAO_PILHA_CURTA;
+    Peca q[3], s[3];
+    for (int i = 0; i < 3; ++i) {
+        q[i] = *pecaDaFila(f, (unsigned int) i);
+        s[i] = p->dados[p->topo - i];
+    }
+    for (int i = 0; i < 3; ++i) {
+        *pecaDaFila(f, (unsigned int) i) = s[i];
+        p->dados[p->topo - 2 + i] = q[i];
+    }
+    return ACAO_OK;
+}
+
+/* --- Histórico (desfazer/refazer) --- */
+
+/* Anel para as últimas capacidade versões (arredondada para potência de 2) */
+void criarHistorico(Historico *h, unsigned int capacidade) {
+    unsigned int cap = 1;
+    while (cap < capacidade) cap <<= 1;
+    h->deltas = (Delta*) malloc(cap * sizeof(Delta));
+    if (!h->deltas) {
+        perror("malloc historico");
+        exit(1);
+    }
+    h->mascara = cap - 1;
+    h->base = h->atual = h->fim = 0;
+}
+
+void liberarHistorico(Historico *h) {
+    free(h->deltas);
+    h->deltas = NULL;
+    h->mascara = 0;
+    h->base = h->atual = h->fim = 0;
+}
+
+/* Esquece tudo: o estado atual vira a única versão */
+void limparHistorico(Historico *h) {
+    h->base = h->fim = h->atual;
+}
+
+/* Anota uma ação já aplicada; descarta o que havia para refazer (o histórico é linear:
+   uma ação nova depois de desfazer apaga o ramo desfeito) e, com o anel cheio, a versão
+   mais antiga */
+void registrarAcao(Historico *h, char acao, Peca peca, int repostas, Peca reposta) {
+    Delta *d = &h->deltas[h->atual & h->mascara];
+    d->acao = acao;
+    d->repostas = (char) repostas;
+    d->peca = peca;
+    d->reposta = reposta;
+    h->fim = ++h->atual;
+    if (h->fim - h->base > h->mascara + 1) h->base = h->fim - (h->mascara + 1);
+}
+
+/* Devolve uma peça para a frente da fila (inverso do dequeue) */
+static void devolverFrente(Fila *f, Peca px) {
+    f->cabeca--;
+    f->dados[f->cabeca & f->mascara] = px;
+}
+
+/* Inverso da troca múltipla: os 3 do topo da pilha voltam para a frente da fila e os
+   3 primeiros da fila voltam para a pilha */
+static void destrocarTres(Fila *f, Pilha *p) {
+    Peca q[3], s[3];
+    for (int i = 0; i < 3; ++i) {
+        q[i] = *pecaDaFila(f, (unsigned int) i);
+        s[i] = p->dados[p->topo - 2 + i];
+    }
+    for (int i = 0; i < 3; ++i) {
+        *pecaDaFila(f, (unsigned int) i) = s[i];
+        p->dados[p->topo - i] = q[i];
+    }
+}
+
+/* Desfaz a última ação; retorna a letra da ação ou 0 se não há o que desfazer */
+int historicoDesfazer(Historico *h, Fila *f, Pilha *p) {
+    if (h->atual == h->base) return 0;
+    const Delta *d = &h->deltas[--h->atual & h->mascara];
+    switch (d->acao) {
+        case 'j':
+        case 'r':
+            if (d->repostas) f->cauda--;
+            if (d->acao == 'r') p->topo--;
+            devolverFrente(f, d->peca);
+            break;
+        case 'u': push(p, d->peca); break;
+        case 't': acaoTrocar(f, p); break;
+        case 'm': destrocarTres(f, p); break;
+    }
+    return d->acao;
+}
+
+/* Refaz a próxima ação desfeita, com as mesmas peças de reposição */
+int historicoRefazer(Historico *h, Fila *f, Pilha *p) {
+    if (h->atual == h->fim) return 0;
+    const Delta *d = &h->deltas[h->atual++ & h->mascara];
+    Peca px;
+    switch (d->acao) {
+        case 'j': acaoJogar(f, &px); break;
+        case 'r': acaoReservar(f, p, &px); break;
+        case 'u': acaoUsar(p, &px); break;
+        case 't': acaoTrocar(f, p); break;
+        case 'm': acaoTrocarTres(f, p); break;
+    }
+    if (d->repostas) enqueue(f, d->reposta);
+    return d->acao;
+}
+
+/* Leva fila e pilha à versão pedida, entre base e fim do histórico linear (desfazendo
+   ou refazendo passo a passo); retorna 0 se ela já saiu do anel ou não existe */
+int voltarParaVersao(Historico *h, Fila *f, Pilha *p, unsigned int versao) {
+    if (versao - h->base > h->fim - h->base) return 0;
+    while (h->atual != versao) {
+        if (versao - h->base < h->atual - h->base) historicoDesfazer(h, f, p);
+        else historicoRefazer(h, f, p);
+    }
+    return 1;
+}
+
+/* Registra no histórico global (se ativo) a ação do menu; antes = tamanho da fila antes
+   da reposição. Reposições de mais de uma peça não cabem no delta: o histórico é limpo. */
+static void anotarNoHistorico(char acao, Peca peca, const Fila *f, unsigned int antes) {
+    if (!historico) return;
+    unsigned int repostas = f ? tamanhoFila(f) - antes : 0;
+    if (repostas > 1) {
+        limparHistorico(historico);
+        return;
+    }
+    Peca reposta = { '?', -1 };
+    if (repostas) reposta = *pecaDaFila(f, tamanhoFila(f) - 1);
+    registrarAcao(historico, acao, peca, (int) repostas, reposta);
+}
+
+static const char* nomeDaAcao(int acao) {
+    switch (acao) {
+        case 'j': return "jogar peça";
+        case 'r': return "reservar peça";
+        case 'u': return "usar peça reservada";
+        case 't': return "trocar frente e topo";
+        default: return "troca múltipla";
+    }
+}
+
+void desfazerAcao(Fila *f, Pilha *p) {
+    int acao = historico ? historicoDesfazer(historico, f, p) : 0;
+    if (!acao) {
+        printf("Nada para desfazer.\n");
+        return;
+    }
+    printf("Desfeito: %s.\n", nomeDaAcao(acao));
+}
+
+void refazerAcao(Fila *f, Pilha *p) {
+    int acao = historico ? historicoRefazer(historico, f, p) : 0;
+    if (!acao) {
+        printf("Nada para refazer.\n");
+        return;
+    }
+    printf("Refeito: %s.\n", nomeDaAcao(acao));
+}
+
+/* Jogar peça: remove da frente da fila (dequeue) e gera nova peça para manter fila cheia */
+void jogarPeca(Fila *f) {
+    Peca jogada;
+    if (acaoJogar(f, &jogada) != ACAO_OK) {
+        printf("Fila vazia: nada para jogar.\n");
+        return;
+    }
+    printf("Jogou a peça: [%c %d]\n", jogada.nome, jogada.id);
+    /* Gerar nova peça e enfileirar (manter fila cheia quando possível) */
+    unsigned int antes = tamanhoFila(f);
+    reabastecerFila(f);
+    anotarNoHistorico('j', jogada, f, antes);
+}
+
+/* Reservar peça: move a peça da frente da fila para o topo da pilha, se pilha tiver espaço.
+   Após mover, gera nova peça para manter fila cheia */
+void reservarPeca(Fila *f, Pilha *p) {
+    Peca mover;
+    int r = acaoReservar(f, p, &mover);
+    if (r == ACAO_FILA_VAZIA) {
+        printf("Fila vazia: nada para reservar.\n");
+        return;
+    }
+    if (r == ACAO_PILHA_CHEIA) {
+        printf("Pilha cheia: não é possível reservar (pilha com capacidade máxima).\n");
+        return;
+    }
+    printf("Reservou a peça [%c %d] para a pilha (topo).\n", mover.nome, mover.id);
+    /* Gerar nova peça para manter fila cheia */
+    unsigned int antes = tamanhoFila(f);
+    reabastecerFila(f);
+    anotarNoHistorico('r', mover, f, antes);
+}
+
+/* Usar peça reservada (pop da pilha) */
+void usarPecaReservada(Pilha *p) {
+    Peca usada;
+    if (acaoUsar(p, &usada) != ACAO_OK) {
+        printf("Pilha vazia: nenhuma peça reservada para usar.\n");
+        return;
+    }
+    printf("Usou a peça reservada: [%c %d]\n", usada.nome, usada.id);
+    anotarNoHistorico('u', usada, NULL, 0);
+    /* NÃO geramos nova peça aqui; somente remoções/transferências da fila geram novas peças. */
+}
+
+/* Trocar peça da frente da fila com o topo da pilha */
+void trocarFrenteTopo(Fila *f, Pilha *p) {
+    int r = acaoTrocar(f, p);
+    if (r == ACAO_FILA_VAZIA) {
+        printf("Fila vazia: nada para trocar.\n");
+        return;
+    }
+    if (r == ACAO_PILHA_VAZIA) {
+        printf("Pilha vazia: nada no topo para trocar.\n");
+        return;
+    }
+    printf("Troca realizada entre frente da fila e topo da pilha.\n");
+    anotarNoHistorico('t', *pecaDaFila(f, 0), f, tamanhoFila(f));
+    /* Observação: não geramos novas peças aqui porque não ocorreu remoção da fila. */
+}
+
+/* Troca múltipla: alterna as três primeiras da fila com as três da pilha
+   Condição: fila deve ter pelo menos 3 peças e pilha ter pelo menos 3 peças */
+void trocarTres(Fila *f, Pilha *p) {
+    int r = acaoTrocarTres(f, p);
+    if (r == ACAO_FILA_CURTA) {
+        printf("A fila não tem 3 peças disponíveis para a troca.\n");
+        return;
+    }
+    if (r == ACAO_PILHA_CURTA) {
+        printf("A pilha não tem 3 peças (pelo menos) para a troca.\n");
+        return;
+    }
+    printf("Troca realizada entre os 3 primeiros da fila e as 3 peças do topo da pilha.\n");
+    anotarNoHistorico('m', *pecaDaFila(f, 0), f, tamanhoFila(f));
+}
+
+/* Anel SPSC com capacidade potência de 2 (arredondada para cima) */
+void criarAnelSPSC(AnelSPSC *a, unsigned int capacidade) {
+    unsigned int cap = 1;
+    while (cap < capacidade) cap <<= 1;
+    a->dados = (Peca*) malloc(cap * sizeof(Peca));
+    if (!a->dados) {
+        perror("malloc anel");
+        exit(1);
+    }
+    a->mascara = cap - 1;
+    atomic_init(&a->cauda, 0);
+    atomic_init(&a->cabeca, 0);
+    a->cabecaVista = a->caudaVista = 0;
+}
+
+/* Produtor: copia até n peças e as publica com um único store (publicação em lote) */
+unsigned int publicarSPSC(AnelSPSC *a, const Peca *px, unsigned int n) {
+    unsigned int cauda = atomic_load_explicit(&a->cauda, memory_order_relaxed);
+    unsigned int livre = a->mascara + 1 - (cauda - a->cabecaVista);
+    if (livre < n) {
+        a->cabecaVista = atomic_load_explicit(&a->cabeca, memory_order_acquire);
+        livre = a->mascara + 1 - (cauda - a->cabecaVista);
+    }
+    if (n > livre) n = livre;
+    for (unsigned int i = 0; i < n; ++i) a->dados[(cauda + i) & a->mascara] = px[i];
+    atomic_store_explicit(&a->cauda, cauda + n, memory_order_release);
+    return n;
+}
+
+/* Consumidor: retira até n peças já publicadas, sem esperar */
+unsigned int consumirSPSC(AnelSPSC *a, Peca *saida, unsigned int n) {
+    unsigned int cabeca = atomic_load_explicit(&a->cabeca, memory_order_relaxed);
+    unsigned int prontas = a->caudaVista - cabeca;
+    if (prontas < n) {
+        a->caudaVista = atomic_load_explicit(&a->cauda, memory_order_acquire);
+        prontas = a->caudaVista - cabeca;
+    }
+    if (n > prontas) n = prontas;
+    for (unsigned int i = 0; i < n; ++i) saida[i] = a->dados[(cabeca + i) & a->mascara];
+    atomic_store_explicit(&a->cabeca, cabeca + n, memory_order_release);
+    return n;
+}
+
+/* Anel MPMC com capacidade potência de 2; a célula i começa livre para a posição i */
+void criarAnelMPMC(AnelMPMC *a, unsigned int capacidade) {
+    unsigned int cap = 2;
+    while (cap < capacidade) cap <<= 1;
+    a->celulas = (CelulaMPMC*) malloc(cap * sizeof(CelulaMPMC));
+    if (!a->celulas) {
+        perror("malloc anel");
+        exit(1);
+    }
+    for (unsigned int i = 0; i < cap; ++i) atomic_init(&a->celulas[i].seq, i);
+    a->mascara = cap - 1;
+    atomic_init(&a->cauda, 0);
+    atomic_init(&a->cabeca, 0);
+}
+
+/* Produtor MPMC: reserva a posição com CAS na cauda; 0 se o anel está cheio */
+int publicarMPMC(AnelMPMC *a, Peca px) {
+    unsigned int pos = atomic_load_explicit(&a->cauda, memory_order_relaxed);
+    for (;;) {
+        CelulaMPMC *c = &a->celulas[pos & a->mascara];
+        int dif = (int)(atomic_load_explicit(&c->seq, memory_order_acquire) - pos);
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&a->cauda, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                c->peca = px;
+                atomic_store_explicit(&c->seq, pos + 1, memory_order_release);
+                return 1;
+            }
+        } else if (dif < 0) {
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&a->cauda, memory_order_relaxed);
+        }
+    }
+}
+
+/* Consumidor MPMC: reserva a posição com CAS na cabeça; 0 se o anel está vazio */
+int consumirMPMC(AnelMPMC *a, Peca *saida) {
+    unsigned int pos = atomic_load_explicit(&a->cabeca, memory_order_relaxed);
+    for (;;) {
+        CelulaMPMC *c = &a->celulas[pos & a->mascara];
+        int dif = (int)(atomic_load_explicit(&c->seq, memory_order_acquire) - (pos + 1));
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&a->cabeca, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *saida = c->peca;
+                atomic_store_explicit(&c->seq, pos + a->mascara + 1, memory_order_release);
+                return 1;
+            }
+        } else if (dif < 0) {
+            return 0;
+        } else {
+            pos = atomic_load_explicit(&a->cabeca, memory_order_relaxed);
+        }
+    }
+}
+
+/* Gera um lote de LOTE_PRODUCAO peças com o gerador g; os ids são reservados com um
+   único fetch_add */
+static void gerarLote(AlimentadorPecas *al, GeradorPecas *g, Peca lote[]) {
+    int id = atomic_fetch_add_explicit(&al->proximoId, LOTE_PRODUCAO, memory_order_relaxed);
+    gerarPecas(g, lote, LOTE_PRODUCAO, id);
+}
+
+/* Publica lote[0..n) no anel do alimentador; retorna quantas couberam */
+static unsigned int publicarLote(AlimentadorPecas *al, const Peca *lote, unsigned int n) {
+    if (!al->multi) return publicarSPSC(&al->spsc, lote, n);
+    unsigned int k = 0;
+    while (k < n && publicarMPMC(&al->mpmc, lote[k])) k++;
+    return k;
+}
+
+/* Produtora com o anel cheio: dorme até o jogador retirar peças ou o alimentador parar.
+   Anuncia que vai dormir e tenta publicar de novo antes de esperar; as barreiras aqui e
+   em retirarPecas garantem que um dos dois lados vê o outro, então o sinal não se perde. */
+static unsigned int esperarEspaco(AlimentadorPecas *al, const Peca *lote, unsigned int n) {
+    unsigned int k;
+    pthread_mutex_lock(&al->trava);
+    atomic_fetch_add_explicit(&al->dormindo, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    while ((k = publicarLote(al, lote, n)) == 0 && !atomic_load_explicit(&al->parar, memory_order_relaxed))
+        pthread_cond_wait(&al->espaco, &al->trava);
+    atomic_fetch_sub_explicit(&al->dormindo, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&al->trava);
+    return k;
+}
+
+/* Corpo de cada thread produtora: gera e publica lotes; dorme quando o anel está cheio */
+static void* produzirPecas(void *arg) {
+    ProdutorPecas *pr = (ProdutorPecas*) arg;
+    AlimentadorPecas *al = pr->al;
+    Peca lote[LOTE_PRODUCAO];
+    unsigned int prontas = 0, enviadas = 0;
+    while (!atomic_load_explicit(&al->parar, memory_order_relaxed)) {
+        if (enviadas == prontas) {
+            gerarLote(al, &pr->gerador, lote);
+            prontas = LOTE_PRODUCAO;
+            enviadas = 0;
+        }
+        unsigned int k = publicarLote(al, lote + enviadas, prontas - enviadas);
+        if (k == 0) k = esperarEspaco(al, lote + enviadas, prontas - enviadas);
+        enviadas += k;
+    }
+    return NULL;
+}
+
+/* Liga o alimentador: anel com a capacidade dada e numProdutores threads (SPSC usa uma
+   só). Enquanto estiver em 'alimentador', jogar/reservar repõem a fila a partir dele. */
+void iniciarAlimentador(AlimentadorPecas *al, int multi, int numProdutores, unsigned int capacidade) {
+    al->multi = multi;
+    if (!multi || numProdutores < 1) numProdutores = 1;
+    if (numProdutores > MAX_PRODUTORES) numProdutores = MAX_PRODUTORES;
+    al->numProdutores = numProdutores;
+    al->spsc.dados = NULL;
+    al->mpmc.celulas = NULL;
+    if (multi) criarAnelMPMC(&al->mpmc, capacidade);
+    else criarAnelSPSC(&al->spsc, capacidade);
+    atomic_init(&al->proximoId, proximoId);
+    atomic_init(&al->parar, 0);
+    atomic_init(&al->dormindo, 0);
+    pthread_mutex_init(&al->trava, NULL);
+    pthread_cond_init(&al->espaco, NULL);
+    /* o anel começa cheio, publicado daqui antes de as produtoras existirem (pthread_create
+       ordena essas escritas antes delas), para a primeira jogada já encontrar peças */
+    GeradorPecas g;
+    semearGerador(&g, prngProximo(origemDasSementes()), DIST_UNIFORME);
+    Peca lote[LOTE_PRODUCAO];
+    do {
+        gerarLote(al, &g, lote);
+    } while (publicarLote(al, lote, LOTE_PRODUCAO) == LOTE_PRODUCAO);
+    /* uma semente para todas as produtoras; cada uma pega o fluxo saltado i vezes */
+    Prng fluxo;
+    prngSemear(&fluxo, prngProximo(origemDasSementes()));
+    for (int i = 0; i < numProdutores; ++i) {
+        ProdutorPecas *pr = &al->produtores[i];
+        pr->al = al;
+        semearGerador(&pr->gerador, 0, DIST_UNIFORME);
+        pr->gerador.prng = fluxo;
+        prngSaltar(&fluxo);
+        if (pthread_create(&pr->thread, NULL, produzirPecas, pr) != 0) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+}
+
+/* Desliga o alimentador; as peças ainda no anel são descartadas e os ids continuam
+   únicos porque proximoId avança para além dos já reservados */
+void pararAlimentador(AlimentadorPecas *al) {
+    atomic_store_explicit(&al->parar, 1, memory_order_relaxed);
+    pthread_mutex_lock(&al->trava);
+    pthread_cond_broadcast(&al->espaco);
+    pthread_mutex_unlock(&al->trava);
+    for (int i = 0; i < al->numProdutores; ++i) pthread_join(al->produtores[i].thread, NULL);
+    pthread_mutex_destroy(&al->trava);
+    pthread_cond_destroy(&al->espaco);
+    proximoId = atomic_load(&al->proximoId);
+    free(al->spsc.dados);
+    free(al->mpmc.celulas);
+    al->spsc.dados = NULL;
+    al->mpmc.celulas = NULL;
+    if (alimentador == al) alimentador = NULL;
+}
+
+/* Lado do jogador: até n peças prontas, sem esperar (0 se o anel está vazio); acorda as
+   produtoras que dormiam com o anel cheio */
+unsigned int retirarPecas(AlimentadorPecas *al, Peca *saida, unsigned int n) {
+    unsigned int k = 0;
+    if (!al->multi) k = consumirSPSC(&al->spsc, saida, n);
+    else while (k < n && consumirMPMC(&al->mpmc, &saida[k])) k++;
+    if (k > 0) {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load_explicit(&al->dormindo, memory_order_relaxed) > 0) {
+            pthread_mutex_lock(&al->trava);
+            pthread_cond_broadcast(&al->espaco);
+            pthread_mutex_unlock(&al->trava);
+        }
+    }
+    return k;
+}
+
+/* Completa a fila: com alimentador, só com peças já prontas no anel (a jogada nunca
+   espera a geração; se o anel estiver vazio a fila fica curta até a próxima ação);
+   sem ele, gera a peça na hora como antes */
+void reabastecerFila(Fila *f) {
+    if (!alimentador) {
+        enqueue(f, gerarPeca());
+        return;
+    }
+    Peca novas[LOTE_PRODUCAO];
+    unsigned int livre = f->limite - tamanhoFila(f);
+    if (livre > LOTE_PRODUCAO) livre = LOTE_PRODUCAO;
+    enqueueVarios(f, novas, retirarPecas(alimentador, novas, livre));
+}
+
+static double relogioParede(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Jogador do benchmark: 'jogadas' jogadas silenciosas (dequeue + reposição) na própria fila.
+   Só conta como jogada a volta que tirou uma peça; com a fila vazia o jogador só tenta repor. */
+typedef struct {
+    long jogadas;
+    long faltas; /* jogadas cuja reposição encontrou o anel vazio */
+    long soma;
+    pthread_t thread;
+} JogadorBench;
+
+static void* jogarBench(void *arg) {
+    JogadorBench *j = (JogadorBench*) arg;
+    Fila f;
+    criarFila(&f, FILA_CAP);
+    for (long feitas = 0; feitas < j->jogadas; ) {
+        int jogou = !filaVazia(&f);
+        if (jogou) {
+            j->soma += dequeue(&f).id;
+            feitas++;
+        }
+        Peca novas[FILA_CAP];
+        unsigned int n = retirarPecas(alimentador, novas, f.limite - tamanhoFila(&f));
+        if (n == 0 && jogou) j->faltas++;
+        enqueueVarios(&f, novas, n);
+    }
+    liberarFila(&f);
+    return NULL;
+}
+
+/* Benchmark: jogadas/s com geração síncrona (gerarPeca em cada jogada), com uma thread
+   produtora e anel SPSC, e com numJogadores jogadores dividindo um anel MPMC */
+void benchmarkAlimentador(long jogadas, int numJogadores) {
+    if (numJogadores < 1) numJogadores = 1;
+    printf("Benchmark do alimentador (%ld jogadas por jogador)\n", jogadas);
+    printf("%-22s | %9s | %14s | %10s\n", "Modo", "jogadores", "jogadas/s", "faltas (%)");
+
+    Fila f;
+    criarFila(&f, FILA_CAP);
+    long soma = 0;
+    double t0 = relogioParede();
+    for (long i = 0; i < jogadas; ++i) {
+        soma += dequeue(&f).id;
+        while (!filaCheia(&f)) enqueue(&f, gerarPeca());
+    }
+    double tempo = relogioParede() - t0;
+    printf("%-22s | %9d | %14.0f | %10.2f\n", "sincrono (gerarPeca)", 1, tempo > 0 ? jogadas / tempo : 0.0, 0.0);
+    liberarFila(&f);
+
+    static AlimentadorPecas al;
+    for (int multi = 0; multi <= 1; ++multi) {
+        int jogadores = multi ? numJogadores : 1;
+        JogadorBench *js = (JogadorBench*) calloc((size_t) jogadores, sizeof(JogadorBench));
+        if (!js) {
+            perror("calloc jogadores");
+            exit(1);
+        }
+        iniciarAlimentador(&al, multi, 1, ANEL_CAP);
+        alimentador = &al;
+        t0 = relogioParede();
+        for (int i = 0; i < jogadores; ++i) {
+            js[i].jogadas = jogadas;
+            if (pthread_create(&js[i].thread, NULL, jogarBench, &js[i]) != 0) {
+                perror("pthread_create");
+                exit(1);
+            }
+        }
+        long faltas = 0;
+        for (int i = 0; i < jogadores; ++i) {
+            pthread_join(js[i].thread, NULL);
+            faltas += js[i].faltas;
+            soma += js[i].soma;
+        }
+        tempo = relogioParede() - t0;
+        pararAlimentador(&al);
+        printf("%-22s | %9d | %14.0f | %10.2f\n", multi ? "MPMC + produtor" : "SPSC + produtor",
+               jogadores, tempo > 0 ? (double) jogadas * jogadores / tempo : 0.0,
+               jogadas > 0 ? 100.0 * faltas / ((double) jogadas * jogadores) : 0.0);
+        free(js);
+    }
+    printf("(checksum %ld)\n", soma);
+}
+
+/* --- Simulador sem interação --- */
+
+/* Índice da ação em CODIGOS_ACAO, ou -1 */
+static int indiceAcao(char c) {
+    for (int k = 0; k < NUM_ACOES; ++k)
+        if (CODIGOS_ACAO[k] == c) return k;
+    return -1;
+}
+
+/* Sequência aleatória de n ações (letras de CODIGOS_ACAO); o chamador libera com free() */
+char* gerarAcoes(GeradorPecas *g, size_t n) {
+    char *acoes = (char*) malloc(n ? n : 1);
+    if (!acoes) {
+        perror("malloc acoes");
+        exit(1);
+    }
+    for (size_t i = 0; i < n; ++i)
+        acoes[i] = CODIGOS_ACAO[((proximoAleatorio(g) >> 32) * NUM_ACOES) >> 32];
+    return acoes;
+}
+
+/* FNV-1a de uma peça acumulado em h */
+static uint64_t hashPeca(uint64_t h, Peca px) {
+    uint32_t v = ((uint32_t) px.id << 8) ^ (unsigned char) px.nome;
+    for (int b = 0; b < 4; ++b) {
+        h ^= (v >> (8 * b)) & 0xFF;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* Invariantes da sessão: limites da fila e da pilha, e conservação das peças em jogo
+   (quantidade e soma dos ids) em relação ao que foi gerado e consumido. Retorna nº de falhas */
+static long verificarSessao(const Fila *f, const Pilha *p, long long emJogo, long long somaIds) {
+    long falhas = 0;
+    unsigned int n = tamanhoFila(f);
+    if (n > f->limite) falhas++;
+    if (p->topo < -1 || p->topo >= p->capacidade) return falhas + 1;
+    long long soma = 0;
+    for (unsigned int i = 0; i < n; ++i) soma += pecaDaFila(f, i)->id;
+    for (int i = 0; i <= p->topo; ++i) soma += p->dados[i].id;
+    if ((long long) n + p->topo + 1 != emJogo) falhas++;
+    if (soma != somaIds) falhas++;
+    return falhas;
+}
+
+/* Completa a fila até o limite com peças de g, em lotes de até LOTE_PRODUCAO (qualquer
+   limite); soma os ids das peças novas em *somaIds. Retorna quantas entraram. */
+static unsigned int reporFilaSimulada(Fila *f, GeradorPecas *g, int *proximoId, long long *somaIds) {
+    Peca novas[LOTE_PRODUCAO];
+    unsigned int total = 0;
+    while (!filaCheia(f)) {
+        unsigned int livre = f->limite - tamanhoFila(f);
+        if (livre > LOTE_PRODUCAO) livre = LOTE_PRODUCAO;
+        gerarPecas(g, novas, livre, *proximoId);
+        *proximoId += (int) livre;
+        enqueueVarios(f, novas, livre);
+        for (unsigned int j = 0; j < livre; ++j) *somaIds += novas[j].id;
+        total += livre;
+    }
+    return total;
+}
+
+/* Aplica n ações à fila/pilha sem E/S: as mesmas regras do menu (ACAO_*), com a fila reposta
+   até o limite por g (ids a partir de *proximoId) antes da primeira ação e após jogar/reservar.
+   Ações impossíveis são contadas em recusadas e não mudam o estado. Com verificar, confere as
+   invariantes após cada ação aplicada; sem, o laço só executa as ações. */
+void simularAcoes(Fila *f, Pilha *p, GeradorPecas *g, int *proximoId, const char *acoes, size_t n,
+                  int verificar, ResultadoSimulacao *r) {
+    memset(r, 0, sizeof(*r));
+    long long somaIds = 0;
+    reporFilaSimulada(f, g, proximoId, &somaIds);
+    long long emJogo = (long long) tamanhoFila(f) + p->topo + 1;
+    somaIds = 0;
+    for (unsigned int i = 0; i < tamanhoFila(f); ++i) somaIds += pecaDaFila(f, i)->id;
+    for (int i = 0; i <= p->topo; ++i) somaIds += p->dados[i].id;
+
+    double t0 = relogioParede();
+    for (size_t i = 0; i < n; ++i) {
+        Peca px;
+        int res;
+        int k = indiceAcao(acoes[i]);
+        switch (k) {
+            case 0: res = acaoJogar(f, &px); break;
+            case 1: res = acaoReservar(f, p, &px); break;
+            case 2: res = acaoUsar(p, &px); break;
+            case 3: res = acaoTrocar(f, p); break;
+            case 4: res = acaoTrocarTres(f, p); break;
+            default: r->desconhecidas++; continue;
+        }
+        if (res != ACAO_OK) {
+            r->recusadas++;
+            continue;
+        }
+        r->aplicadas[k]++;
+        if (k == 0 || k == 2) { /* peça saiu do jogo */
+            emJogo--;
+            somaIds -= px.id;
+        }
+        if (k <= 1) { /* remoção da fila: repõe até o limite */
+            emJogo += reporFilaSimulada(f, g, proximoId, &somaIds);
+            if (verificar && !filaCheia(f)) r->violacoes++;
+        }
+        if (verificar) r->violacoes += verificarSessao(f, p, emJogo, somaIds);
+    }
+    r->segundos = relogioParede() - t0;
+    r->acoes = (long) n;
+
+    r->hashFila = r->hashPilha = 14695981039346656037ULL;
+    for (unsigned int i = 0; i < tamanhoFila(f); ++i) r->hashFila = hashPeca(r->hashFila, *pecaDaFila(f, i));
+    for (int i = p->topo; i >= 0; --i) r->hashPilha = hashPeca(r->hashPilha, p->dados[i]);
+}
+
+/* Benchmark: numAcoes ações aleatórias (semente fixa) com e sem verificação das invariantes;
+   as duas rodadas partem do mesmo estado e devem terminar com os mesmos hashes */
+void benchmarkSimulador(long numAcoes, uint64_t semente) {
+    GeradorPecas gAcoes;
+    semearGerador(&gAcoes, semente, DIST_UNIFORME);
+    char *acoes = gerarAcoes(&gAcoes, (size_t) numAcoes);
+    printf("Benchmark do simulador (%ld ações, semente %llu)\n", numAcoes, (unsigned long long) semente);
+    printf("%-12s | %14s | %9s | %10s | %s\n", "Verificar", "acoes/s", "tempo (s)", "violações",
+           "fila / pilha (hash)");
+
+    /* rodadas 0 e 1: fila padrão cheia, sem e com verificação (mesmo estado final);
+       rodada 2: fila de 100 vazia, reposta em vários lotes de LOTE_PRODUCAO */
+    const unsigned int filaGrande = 100;
+    uint64_t hashes[2][2];
+    for (int rodada = 0; rodada < 3; ++rodada) {
+        int verificar = rodada > 0;
+        Fila f;
+        Pilha p;
+        GeradorPecas g;
+        int proximoId = 0;
+        criarFila(&f, rodada == 2 ? filaGrande : FILA_CAP);
+        criarPilha(&p, PILHA_CAP);
+        semearGerador(&g, semente ^ 0x9E3779B97F4A7C15ULL, DIST_SACO);
+        if (rodada < 2) {
+            Peca iniciais[FILA_CAP];
+            gerarPecas(&g, iniciais, FILA_CAP, proximoId);
+            proximoId += FILA_CAP;
+            enqueueVarios(&f, iniciais, FILA_CAP);
+        }
+
+        ResultadoSimulacao r;
+        simularAcoes(&f, &p, &g, &proximoId, acoes, (size_t) numAcoes, verificar, &r);
+        if (rodada < 2) {
+            hashes[rodada][0] = r.hashFila;
+            hashes[rodada][1] = r.hashPilha;
+        }
+        printf("%-12s | %14.0f | %9.3f | %10ld | %016llx / %016llx\n",
+               rodada == 2 ? "fila 100" : verificar ? "ligada" : "desligada",
+               r.segundos > 0 ? r.acoes / r.segundos : 0.0, r.segundos, r.violacoes,
+               (unsigned long long) r.hashFila, (unsigned long long) r.hashPilha);
+        if (rodada == 1) {
+            printf("Aplicadas j/r/u/t/m: %ld/%ld/%ld/%ld/%ld, recusadas %ld\n", r.aplicadas[0], r.aplicadas[1],
+                   r.aplicadas[2], r.aplicadas[3], r.aplicadas[4], r.recusadas);
+        }
+        liberarFila(&f);
+        liberarPilha(&p);
+    }
+    printf("Estado final igual nas duas rodadas: %s\n",
+           hashes[0][0] == hashes[1][0] && hashes[0][1] == hashes[1][1] ? "sim" : "NAO");
+    free(acoes);
+}
+
+/* --- Peças e sessões compactas --- */
+
+_Static_assert(FILA_CAP == 5 && PILHA_CAP == 3, "SessaoCompacta supõe fila de 5 e pilha de 3");
+
+#define MASCARA_BAIXA 0x00000000FFFFFFFFULL
+#define MASCARA_ALTA 0xFFFFFFFF00000000ULL
+
+PecaCompacta compactarPeca(Peca px) {
+    unsigned int t = 0;
+    while (t < 3 && TIPOS_PECA[t] != px.nome) ++t;
+    return ((uint32_t) px.id << 2) | t;
+}
+
+Peca expandirPeca(PecaCompacta c) {
+    Peca px;
+    px.nome = TIPOS_PECA[c & 3];
+    px.id = (int) (c >> 2);
+    return px;
+}
+
+static PecaCompacta posicaoCompacta(const SessaoCompacta *s, int k) {
+    return (PecaCompacta) (s->w[k >> 1] >> (32 * (k & 1)));
+}
+
+static void gravarPosicao(SessaoCompacta *s, int k, PecaCompacta c) {
+    int d = 32 * (k & 1);
+    s->w[k >> 1] = (s->w[k >> 1] & ~(MASCARA_BAIXA << d)) | ((uint64_t) c << d);
+}
+
+/* Converte fila (limite FILA_CAP) e pilha (capacidade PILHA_CAP) para a forma compacta */
+void compactarSessao(const Fila *f, const Pilha *p, SessaoCompacta *s) {
+    for (int k = 0; k < 4; ++k) s->w[k] = ~0ULL;
+    unsigned int n = tamanhoFila(f);
+    for (unsigned int i = 0; i < n && i < FILA_CAP; ++i) gravarPosicao(s, (int) i, compactarPeca(*pecaDaFila(f, i)));
+    for (int j = 0; j < PILHA_CAP && j <= p->topo; ++j)
+        gravarPosicao(s, FILA_CAP + j, compactarPeca(p->dados[p->topo - j]));
+}
+
+/* Devolve o estado para fila e pilha já criadas (esvaziadas aqui) */
+void expandirSessao(const SessaoCompacta *s, Fila *f, Pilha *p) {
+    f->cabeca = f->cauda = 0;
+    for (int k = 0; k < FILA_CAP && posicaoCompacta(s, k) != PECA_VAZIA; ++k)
+        enqueue(f, expandirPeca(posicaoCompacta(s, k)));
+    int n = 0;
+    while (n < PILHA_CAP && posicaoCompacta(s, FILA_CAP + n) != PECA_VAZIA) ++n;
+    p->topo = n - 1;
+    for (int j = 0; j < n; ++j) p->dados[p->topo - j] = expandirPeca(posicaoCompacta(s, FILA_CAP + j));
+}
+
+/* Ações sobre a forma compacta: mesmas regras e códigos ACAO_* do núcleo, feitas com
+   deslocamentos e máscaras sobre as quatro palavras (sem laços nem desvios por posição) */
+
+/* retira a frente da fila: posições 0..4 andam uma para a frente, a 4 fica vazia */
+static PecaCompacta retirarFrenteCompacta(SessaoCompacta *s) {
+    PecaCompacta frente = (PecaCompacta) s->w[0];
+    s->w[0] = (s->w[0] >> 32) | (s->w[1] << 32);
+    s->w[1] = (s->w[1] >> 32) | (s->w[2] << 32);
+    s->w[2] = (s->w[2] & MASCARA_ALTA) | MASCARA_BAIXA;
+    return frente;
+}
+
+int compactaJogar(SessaoCompacta *s, PecaCompacta *jogada) {
+    if ((PecaCompacta) s->w[0] == PECA_VAZIA) return ACAO_FILA_VAZIA;
+    *jogada = retirarFrenteCompacta(s);
+    return ACAO_OK;
+}
+
+int compactaReservar(SessaoCompacta *s) {
+    if ((PecaCompacta) s->w[0] == PECA_VAZIA) return ACAO_FILA_VAZIA;
+    if ((PecaCompacta) (s->w[3] >> 32) != PECA_VAZIA) return ACAO_PILHA_CHEIA;
+    uint64_t frente = retirarFrenteCompacta(s);
+    /* empilha: 6 -> 7, 5 -> 6, frente -> 5 */
+    s->w[3] = (s->w[3] << 32) | (s->w[2] >> 32);
+    s->w[2] = (s->w[2] & MASCARA_BAIXA) | (frente << 32);
+    return ACAO_OK;
+}
+
+int compactaUsar(SessaoCompacta *s, PecaCompacta *usada) {
+    if ((PecaCompacta) (s->w[2] >> 32) == PECA_VAZIA) return ACAO_PILHA_VAZIA;
+    *usada = (PecaCompacta) (s->w[2] >> 32);
+    s->w[2] = (s->w[2] & MASCARA_BAIXA) | (s->w[3] << 32);
+    s->w[3] = (s->w[3] >> 32) | MASCARA_ALTA;
+    return ACAO_OK;
+}
+
+int compactaTrocar(SessaoCompacta *s) {
+    if ((PecaCompacta) s->w[0] == PECA_VAZIA) return ACAO_FILA_VAZIA;
+    if ((PecaCompacta) (s->w[2] >> 32) == PECA_VAZIA) return ACAO_PILHA_VAZIA;
+    uint64_t x = (s->w[0] ^ (s->w[2] >> 32)) & MASCARA_BAIXA; /* posição 0 <-> posição 5 */
+    s->w[0] ^= x;
+    s->w[2] ^= x << 32;
+    return ACAO_OK;
+}
+
+/* fila recebe (topo, topo-1, topo-2) da pilha; pilha recebe q2 no topo, depois q1 e q0 */
+int compactaTrocarTres(SessaoCompacta *s) {
+    if ((PecaCompacta) s->w[1] == PECA_VAZIA) return ACAO_FILA_CURTA;
+    if ((PecaCompacta) (s->w[3] >> 32) == PECA_VAZIA) return ACAO_PILHA_CURTA;
+    uint64_t w0 = s->w[0], w1 = s->w[1], w2 = s->w[2], w3 = s->w[3];
+    s->w[0] = (w2 >> 32) | (w3 << 32);
+    s->w[1] = (w1 & MASCARA_ALTA) | (w3 >> 32);
+    s->w[2] = (w2 & MASCARA_BAIXA) | (w1 << 32);
+    s->w[3] = (w0 >> 32) | (w0 << 32);
+    return ACAO_OK;
+}
+
+/* Enfileira no fim da fila; retorna 0 se ela já estava cheia */
+int compactaRepor(SessaoCompacta *s, PecaCompacta nova) {
+    for (int k = 0; k < FILA_CAP; ++k) {
+        if (posicaoCompacta(s, k) == PECA_VAZIA) {
+            gravarPosicao(s, k, nova);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* n sessões vazias; cada coluna é alinhada à linha de cache */
+void criarSessoes(SessoesCompactas *ss, size_t n) {
+    ss->n = n;
+    size_t bytes = ((n ? n : 1) * sizeof(uint64_t) + LINHA_CACHE - 1) / LINHA_CACHE * LINHA_CACHE;
+    for (int k = 0; k < 4; ++k) {
+        ss->w[k] = (uint64_t*) aligned_alloc(LINHA_CACHE, bytes);
+        if (!ss->w[k]) {
+            perror("aligned_alloc sessoes");
+            exit(1);
+        }
+        memset(ss->w[k], 0xFF, bytes);
+    }
+}
+
+void liberarSessoes(SessoesCompactas *ss) {
+    for (int k = 0; k < 4; ++k) {
+        free(ss->w[k]);
+        ss->w[k] = NULL;
+    }
+    ss->n = 0;
+}
+
+/* Aplica acoes[i] à sessão i (letras de CODIGOS_ACAO; outras são ignoradas), repondo a fila
+   após jogar/reservar com peças de g (ids a partir de *proximoIdLote). Retorna o nº de
+   ações recusadas, ou -1 sem mexer em nada se a rodada puder passar de ID_COMPACTO_MAX
+   (até ss->n + LOTE_PRODUCAO ids novos): o que fazer com os ids fica com quem chama. */
+long aplicarEmLote(SessoesCompactas *ss, const char *acoes, GeradorPecas *g, int *proximoIdLote) {
+    Peca novas[LOTE_PRODUCAO];
+    int usadas = LOTE_PRODUCAO;
+    long recusadas = 0;
+    if (*proximoIdLote < 0 || (uint64_t) ID_COMPACTO_MAX + 1 - (uint64_t) *proximoIdLote <
+                              (uint64_t) ss->n + LOTE_PRODUCAO)
+        return -1;
+    for (size_t i = 0; i < ss->n; ++i) {
+        SessaoCompacta s = { { ss->w[0][i], ss->w[1][i], ss->w[2][i], ss->w[3][i] } };
+        PecaCompacta px;
+        int res, repor = 0;
+        switch (acoes[i]) {
+            case 'j': res = compactaJogar(&s, &px); repor = 1; break;
+            case 'r': res = compactaReservar(&s); repor = 1; break;
+            case 'u': res = compactaUsar(&s, &px); break;
+            case 't': res = compactaTrocar(&s); break;
+            case 'm': res = compactaTrocarTres(&s); break;
+            default: continue;
+        }
+        if (res != ACAO_OK) {
+            recusadas++;
+            continue;
+        }
+        if (repor) {
+            if (usadas == LOTE_PRODUCAO) {
+                gerarPecas(g, novas, LOTE_PRODUCAO, *proximoIdLote);
+                *proximoIdLote += LOTE_PRODUCAO;
+                usadas = 0;
+            }
+            compactaRepor(&s, compactarPeca(novas[usadas++]));
+        }
+        ss->w[0][i] = s.w[0];
+        ss->w[1][i] = s.w[1];
+        ss->w[2][i] = s.w[2];
+        ss->w[3][i] = s.w[3];
+    }
+    return recusadas;
+}
+
+/* Benchmark: numSessoes sessões compactas em SoA, rodadas de uma ação aleatória por sessão.
+   Antes, confere a forma compacta contra fila/pilha (núcleo acao*) em sequências aleatórias. */
+void benchmarkSessoes(size_t numSessoes, int rodadas) {
+    /* equivalência: mesma sequência de ações e mesmas peças de reposição */
+    GeradorPecas ga;
+    semearGerador(&ga, 77, DIST_UNIFORME);
+    long divergencias = 0;
+    for (int t = 0; t < 100; ++t) {
+        Fila f, fc;
+        Pilha p, pc;
+        criarFila(&f, FILA_CAP);
+        criarFila(&fc, FILA_CAP);
+        criarPilha(&p, PILHA_CAP);
+        criarPilha(&pc, PILHA_CAP);
+        GeradorPecas g;
+        semearGerador(&g, (uint64_t) t, t % 3);
+        int id = 0;
+        SessaoCompacta s;
+        compactarSessao(&f, &p, &s);
+        char *acoes = gerarAcoes(&ga, 1000);
+        for (int i = 0; i < 1000; ++i) {
+            Peca px;
+            PecaCompacta c;
+            int r1, r2;
+            switch (acoes[i]) {
+                case 'j': r1 = acaoJogar(&f, &px); r2 = compactaJogar(&s, &c); break;
+                case 'r': r1 = acaoReservar(&f, &p, &px); r2 = compactaReservar(&s); break;
+                case 'u': r1 = acaoUsar(&p, &px); r2 = compactaUsar(&s, &c); break;
+                case 't': r1 = acaoTrocar(&f, &p); r2 = compactaTrocar(&s); break;
+                default: r1 = acaoTrocarTres(&f, &p); r2 = compactaTrocarTres(&s); break;
+            }
+            if (r1 != r2) divergencias++;
+            while (!filaCheia(&f)) { /* começa vazia: completa a fila aos poucos */
+                Peca nova;
+                gerarPecas(&g, &nova, 1, id++);
+                enqueue(&f, nova);
+                compactaRepor(&s, compactarPeca(nova));
+            }
+            expandirSessao(&s, &fc, &pc);
+            if (tamanhoFila(&fc) != tamanhoFila(&f) || pc.topo != p.topo) {
+                divergencias++;
+                continue;
+            }
+            for (unsigned int k = 0; k < tamanhoFila(&f); ++k)
+                divergencias += pecaDaFila(&f, k)->id != pecaDaFila(&fc, k)->id ||
+                                pecaDaFila(&f, k)->nome != pecaDaFila(&fc, k)->nome;
+            for (int k = 0; k <= p.topo; ++k)
+                divergencias += p.dados[k].id != pc.dados[k].id || p.dados[k].nome != pc.dados[k].nome;
+        }
+        free(acoes);
+        liberarFila(&f);
+        liberarFila(&fc);
+        liberarPilha(&p);
+        liberarPilha(&pc);
+    }
+
+    SessoesCompactas ss;
+    criarSessoes(&ss, numSessoes);
+    GeradorPecas g;
+    semearGerador(&g, 2024, DIST_SACO);
+    int id = 0;
+    for (size_t i = 0; i < numSessoes; ++i) {
+        SessaoCompacta s = { { ~0ULL, ~0ULL, ~0ULL, ~0ULL } };
+        for (int k = 0; k < FILA_CAP; ++k) {
+            Peca nova;
+            gerarPecas(&g, &nova, 1, id++);
+            compactaRepor(&s, compactarPeca(nova));
+        }
+        for (int k = 0; k < 4; ++k) ss.w[k][i] = s.w[k];
+    }
+
+    /* rodada r usa acoes[r .. r + numSessoes) */
+    char *acoes = gerarAcoes(&ga, numSessoes + (size_t) rodadas);
+    long recusadas = 0;
+    double t0 = relogioParede();
+    for (int r = 0; r < rodadas; ++r) {
+        long res = aplicarEmLote(&ss, acoes + r, &g, &id);
+        if (res < 0) {
+            /* ids esgotados: aqui eles só rotulam peças, então recomeçar do 0 é aceitável */
+            id = 0;
+            res = aplicarEmLote(&ss, acoes + r, &g, &id);
+            if (res < 0) {
+                fprintf(stderr, "Sessões demais para os ids compactos\n");
+                break;
+            }
+        }
+        recusadas += res;
+    }
+    double tempo = relogioParede() - t0;
+
+    printf("Sessões compactas: %zu sessões x %d rodadas, %zu bytes/sessão (Fila+Pilha: %zu + dados)\n",
+           numSessoes, rodadas, sizeof(SessaoCompacta), sizeof(Fila) + sizeof(Pilha));
+    printf("%14.0f atualizações/s, %.3f s, recusadas %ld, divergências com fila/pilha: %ld\n",
+           tempo > 0 ? (double) numSessoes * rodadas / tempo : 0.0, tempo, recusadas, divergencias);
+    free(acoes);
+    liberarSessoes(&ss);
+}
+
+/* --- Solver: aprofundamento iterativo sobre sessões compactas ---
+   O fluxo de peças vem de um gerador semeado, então a k-ésima reposição é sempre a
+   peça k do fluxo: o estado é (sessão, próxima peça do fluxo, quanto do padrão já foi
+   jogado). Só os tipos importam para o objetivo, e a tabela de transposição usa hash de
+   Zobrist dos tipos por posição, misturado com os dois contadores. As threads dividem
+   as subárvores abaixo das duas primeiras ações; cada uma tem a própria tabela. */
+
+static uint64_t ZOBRIST[FILA_CAP + PILHA_CAP][5]; /* [posição][tipo, 4 = vazia] */
+static int zobristPronto = 0;
+
+typedef struct {
+    const PecaCompacta *fluxo;
+    const char *padrao;
+    int tamPadrao;
+    uint64_t *tabela; /* chave nos 56 bits altos, profundidade restante nos 8 baixos */
+    uint64_t mascaraTabela;
+    long long nos;
+    int limite;
+    char caminho[SOLVER_PROF_MAX];
+    _Atomic int *melhorRaiz; /* menor índice de subárvore com solução nesta iteração */
+    int raizAtual;
+} BuscaPecas;
+
+typedef struct {
+    BuscaPecas busca;
+    const SessaoCompacta *raizes;
+    const int *proxRaiz, *progRaiz;
+    const char (*acoesRaiz)[2];
+    int numRaizes;
+    _Atomic int *proximaRaiz;
+    char solucao[SOLVER_PROF_MAX + 1];
+    int achou;
+    pthread_t thread;
+} TrabalhadorSolver;
+
+static uint64_t misturar64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static uint64_t chaveZobrist(const SessaoCompacta *s, int prox, int progresso) {
+    uint64_t h = misturar64(((uint64_t) prox << 8) | (uint64_t) progresso);
+    for (int k = 0; k < FILA_CAP + PILHA_CAP; ++k) {
+        PecaCompacta c = posicaoCompacta(s, k);
+        h ^= ZOBRIST[k][c == PECA_VAZIA ? 4 : (c & 3)];
+    }
+    return h;
+}
+
+/* Aplica a ação c; retorna 0 se ela é recusada ou joga uma peça fora do padrão */
+static int passoSolver(const BuscaPecas *b, SessaoCompacta *s, char c, int *prox, int *progresso) {
+    PecaCompacta px;
+    int res;
+    switch (c) {
+        case 'j': res = compactaJogar(s, &px); break;
+        case 'r': res = compactaReservar(s); break;
+        case 'u': res = compactaUsar(s, &px); break;
+        case 't': res = compactaTrocar(s); break;
+        default: res = compactaTrocarTres(s); break;
+    }
+    if (res != ACAO_OK) return 0;
+    if (c == 'j' || c == 'u') {
+        if (*progresso >= b->tamPadrao || TIPOS_PECA[px & 3] != b->padrao[*progresso]) return 0;
+        (*progresso)++;
+    }
+    if (c == 'j' || c == 'r') compactaRepor(s, b->fluxo[(*prox)++]);
+    return 1;
+}
+
+static int buscarPadrao(BuscaPecas *b, const SessaoCompacta *s, int prox, int progresso, int g, char anterior) {
+    b->nos++;
+    if (progresso == b->tamPadrao) return 1;
+    if (g + (b->tamPadrao - progresso) > b->limite) return 0; /* cada peça do padrão custa uma ação */
+    if (atomic_load_explicit(b->melhorRaiz, memory_order_relaxed) < b->raizAtual) return 0;
+
+    uint64_t restante = (uint64_t) (b->limite - g);
+    uint64_t chave = chaveZobrist(s, prox, progresso);
+    uint64_t *e = &b->tabela[chave & b->mascaraTabela];
+    if ((*e >> 8) == (chave >> 8) && (*e & 0xFF) >= restante) return 0;
+
+    static const char ORDEM[NUM_ACOES] = { 'j', 'u', 'r', 't', 'm' }; /* jogadas primeiro */
+    for (int a = 0; a < NUM_ACOES; ++a) {
+        char c = ORDEM[a];
+        if (c == 't' && anterior == 't') continue; /* trocar duas vezes volta ao mesmo estado */
+        SessaoCompacta filho = *s;
+        int p2 = prox, pr2 = progresso;
+        if (!passoSolver(b, &filho, c, &p2, &pr2)) continue;
+        b->caminho[g] = c;
+        if (buscarPadrao(b, &filho, p2, pr2, g + 1, c)) return 1;
+    }
+    /* só grava subárvores buscadas por inteiro (não interrompidas por outra thread) */
+    if (atomic_load_explicit(b->melhorRaiz, memory_order_relaxed) >= b->raizAtual)
+        *e = (chave & ~0xFFULL) | restante;
+    return 0;
+}
+
+static void* trabalharSolver(void *arg) {
+    TrabalhadorSolver *t = (TrabalhadorSolver*) arg;
+    BuscaPecas *b = &t->busca;
+    for (;;) {
+        int r = atomic_fetch_add(t->proximaRaiz, 1);
+        if (r >= t->numRaizes || atomic_load(b->melhorRaiz) < r) break;
+        b->raizAtual = r;
+        b->caminho[0] = t->acoesRaiz[r][0];
+        b->caminho[1] = t->acoesRaiz[r][1];
+        if (buscarPadrao(b, &t->raizes[r], t->proxRaiz[r], t->progRaiz[r], 2, t->acoesRaiz[r][1])) {
+            int atual = atomic_load(b->melhorRaiz);
+            while (r < atual && !atomic_compare_exchange_weak(b->melhorRaiz, &atual, r)) {}
+            if (r <= atomic_load(b->melhorRaiz)) {
+                memcpy(t->solucao, b->caminho, (size_t) b->limite);
+                t->solucao[b->limite] = '\0';
+                t->achou = 1;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Fluxo determinístico: as FILA_CAP primeiras enchem a fila, as seguintes repõem em ordem */
+static PecaCompacta* fluxoDoSolver(uint64_t semente, int distribuicao, int n) {
+    GeradorPecas g;
+    semearGerador(&g, semente, distribuicao);
+    Peca *pecas = (Peca*) malloc((size_t) n * sizeof(Peca));
+    PecaCompacta *fluxo = (PecaCompacta*) malloc((size_t) n * sizeof(PecaCompacta));
+    if (!pecas || !fluxo) {
+        perror("malloc fluxo");
+        exit(1);
+    }
+    gerarPecas(&g, pecas, (size_t) n, 0);
+    for (int i = 0; i < n; ++i) fluxo[i] = compactarPeca(pecas[i]);
+    free(pecas);
+    return fluxo;
+}
+
+/* Procura a menor sequência de ações (até profundidadeMax) cujas peças jogadas formam
+   padrao (letras de TIPOS_PECA), partindo da fila cheia e pilha vazia com as peças do
+   gerador semeado. Retorna 1 se achou; sol recebe a sequência e as estatísticas. */
+int resolverPadrao(uint64_t semente, int distribuicao, const char *padrao, int profundidadeMax, int numThreads,
+                   unsigned int bitsTabela, SolucaoPecas *sol) {
+    memset(sol, 0, sizeof(*sol));
+    sol->movimentos = -1;
+    int tamPadrao = (int) strlen(padrao);
+    for (int i = 0; i < tamPadrao; ++i)
+        if (!memchr(TIPOS_PECA, padrao[i], sizeof(TIPOS_PECA))) return 0;
+    if (profundidadeMax > SOLVER_PROF_MAX) profundidadeMax = SOLVER_PROF_MAX;
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAX_PRODUTORES) numThreads = MAX_PRODUTORES;
+    if (bitsTabela < 10) bitsTabela = 10;
+    if (bitsTabela > 28) bitsTabela = 28;
+
+    if (!zobristPronto) {
+        GeradorPecas gz;
+        semearGerador(&gz, 0x5EEDC0DEULL, DIST_UNIFORME);
+        for (int k = 0; k < FILA_CAP + PILHA_CAP; ++k)
+            for (int t = 0; t < 5; ++t) ZOBRIST[k][t] = proximoAleatorio(&gz);
+        zobristPronto = 1;
+    }
+
+    int tamFluxo = FILA_CAP + profundidadeMax;
+    PecaCompacta *fluxo = fluxoDoSolver(semente, distribuicao, tamFluxo);
+    SessaoCompacta inicio = { { ~0ULL, ~0ULL, ~0ULL, ~0ULL } };
+    for (int i = 0; i < FILA_CAP; ++i) compactaRepor(&inicio, fluxo[i]);
+
+    size_t entradas = (size_t) 1 << bitsTabela;
+    TrabalhadorSolver *ts = (TrabalhadorSolver*) calloc((size_t) numThreads, sizeof(TrabalhadorSolver));
+    if (!ts) {
+        perror("calloc solver");
+        exit(1);
+    }
+    _Atomic int melhorRaiz, proximaRaiz;
+    for (int i = 0; i < numThreads; ++i) {
+        BuscaPecas *b = &ts[i].busca;
+        b->fluxo = fluxo;
+        b->padrao = padrao;
+        b->tamPadrao = tamPadrao;
+        b->tabela = (uint64_t*) calloc(entradas, sizeof(uint64_t));
+        if (!b->tabela) {
+            perror("calloc tabela de transposicao");
+            exit(1);
+        }
+        b->mascaraTabela = entradas - 1;
+        b->melhorRaiz = &melhorRaiz;
+    }
+    sol->memoria = (size_t) numThreads * entradas * sizeof(uint64_t) + (size_t) tamFluxo * sizeof(PecaCompacta);
+
+    /* subárvores abaixo das duas primeiras ações (a ordem delas fixa o desempate) */
+    SessaoCompacta raizes[NUM_ACOES * NUM_ACOES];
+    int proxRaiz[NUM_ACOES * NUM_ACOES], progRaiz[NUM_ACOES * NUM_ACOES];
+    char acoesRaiz[NUM_ACOES * NUM_ACOES][2];
+    int numRaizes = 0;
+    BuscaPecas *b0 = &ts[0].busca;
+    for (int a = 0; a < NUM_ACOES; ++a) {
+        SessaoCompacta s1 = inicio;
+        int p1 = FILA_CAP, pr1 = 0;
+        if (!passoSolver(b0, &s1, CODIGOS_ACAO[a], &p1, &pr1)) continue;
+        for (int c = 0; c < NUM_ACOES; ++c) {
+            SessaoCompacta s2 = s1;
+            int p2 = p1, pr2 = pr1;
+            if (!passoSolver(b0, &s2, CODIGOS_ACAO[c], &p2, &pr2)) continue;
+            raizes[numRaizes] = s2;
+            proxRaiz[numRaizes] = p2;
+            progRaiz[numRaizes] = pr2;
+            acoesRaiz[numRaizes][0] = CODIGOS_ACAO[a];
+            acoesRaiz[numRaizes][1] = CODIGOS_ACAO[c];
+            numRaizes++;
+        }
+    }
+
+    double t0 = relogioParede();
+    for (int limite = tamPadrao; limite <= profundidadeMax && sol->movimentos < 0; ++limite) {
+        atomic_store(&melhorRaiz, INT32_MAX);
+        if (limite < 2) { /* rasa demais para dividir: busca direto da raiz */
+            b0->limite = limite;
+            b0->raizAtual = 0;
+            atomic_store(&melhorRaiz, 0);
+            if (buscarPadrao(b0, &inicio, FILA_CAP, 0, 0, 0)) {
+                memcpy(sol->acoes, b0->caminho, (size_t) limite);
+                sol->movimentos = limite;
+            }
+            sol->profundidade = limite;
+            continue;
+        }
+        atomic_store(&proximaRaiz, 0);
+        for (int i = 0; i < numThreads; ++i) {
+            ts[i].busca.limite = limite;
+            ts[i].raizes = raizes;
+            ts[i].proxRaiz = proxRaiz;
+            ts[i].progRaiz = progRaiz;
+            ts[i].acoesRaiz = (const char (*)[2]) acoesRaiz;
+            ts[i].numRaizes = numRaizes;
+            ts[i].proximaRaiz = &proximaRaiz;
+            ts[i].achou = 0;
+            if (pthread_create(&ts[i].thread, NULL, trabalharSolver, &ts[i]) != 0) {
+                perror("pthread_create");
+                exit(1);
+            }
+        }
+        for (int i = 0; i < numThreads; ++i) pthread_join(ts[i].thread, NULL);
+        sol->profundidade = limite;
+        /* várias threads podem achar; vale a da menor subárvore, como na busca sequencial */
+        int vencedora = atomic_load(&melhorRaiz);
+        for (int i = 0; i < numThreads && vencedora != INT32_MAX; ++i) {
+            if (ts[i].achou && ts[i].busca.raizAtual == vencedora) {
+                memcpy(sol->acoes, ts[i].solucao, (size_t) limite + 1);
+                sol->movimentos = limite;
+            }
+        }
+    }
+    sol->segundos = relogioParede() - t0;
+
+    for (int i = 0; i < numThreads; ++i) {
+        sol->nos += ts[i].busca.nos;
+        free(ts[i].busca.tabela);
+    }
+    free(ts);
+    free(fluxo);
+    return sol->movimentos >= 0;
+}
+
+/* Reexecuta acoes com Fila/Pilha (núcleo acao*) e o mesmo fluxo; retorna 1 se todas
+   são aceitas e as peças jogadas formam exatamente o padrão */
+int conferirSolucao(uint64_t semente, int distribuicao, const char *padrao, const char *acoes) {
+    int n = (int) strlen(acoes);
+    PecaCompacta *fluxo = fluxoDoSolver(semente, distribuicao, FILA_CAP + n);
+    Fila f;
+    Pilha p;
+    criarFila(&f, FILA_CAP);
+    criarPilha(&p, PILHA_CAP);
+    for (int i = 0; i < FILA_CAP; ++i) enqueue(&f, expandirPeca(fluxo[i]));
+    int prox = FILA_CAP, jogadas = 0, ok = 1;
+    for (int i = 0; i < n && ok; ++i) {
+        Peca px;
+        int res;
+        switch (acoes[i]) {
+            case 'j': res = acaoJogar(&f, &px); break;
+            case 'r': res = acaoReservar(&f, &p, &px); break;
+            case 'u': res = acaoUsar(&p, &px); break;
+            case 't': res = acaoTrocar(&f, &p); break;
+            case 'm': res = acaoTrocarTres(&f, &p); break;
+            default: res = -1; break;
+        }
+        ok = res == ACAO_OK;
+        if (ok && (acoes[i] == 'j' || acoes[i] == 'u')) ok = padrao[jogadas++] == px.nome;
+        if (ok && (acoes[i] == 'j' || acoes[i] == 'r')) enqueue(&f, expandirPeca(fluxo[prox++]));
+    }
+    ok = ok && padrao[jogadas] == '\0';
+    liberarFila(&f);
+    liberarPilha(&p);
+    free(fluxo);
+    return ok;
+}
+
+/* Benchmark: resolve o padrão com 1 thread e com numThreads, conferindo a solução */
+void benchmarkSolver(uint64_t semente, const char *padrao, int numThreads) {
+    printf("Solver: padrão \"%s\", semente %llu, saco de 4\n", padrao, (unsigned long long) semente);
+    printf("%-8s | %9s | %14s | %9s | %10s | %s\n", "Threads", "ações", "nós/s", "tempo (s)", "memória", "sequência");
+    for (int n = 1; n <= numThreads; n = n == numThreads ? n + 1 : (n * 2 < numThreads ? n * 2 : numThreads)) {
+        SolucaoPecas sol;
+        int achou = resolverPadrao(semente, DIST_SACO, padrao, SOLVER_PROF_MAX, n, SOLVER_BITS_TT, &sol);
+        printf("%-8d | %9d | %14.0f | %9.3f | %7zu KB | %s%s\n", n, sol.movimentos,
+               sol.segundos > 0 ? sol.nos / sol.segundos : 0.0, sol.segundos, sol.memoria / 1024,
+               achou ? sol.acoes : "(sem solução)",
+               achou ? (conferirSolucao(semente, DIST_SACO, padrao, sol.acoes) ? " (conferida)" : " (INVALIDA)") : "");
+    }
+}
+
+/* Menu e interação */
+void mostrarMenu() {
+    if (!saidaTexto(SAIDA_NORMAL)) return;
+    printf("Opções disponíveis:\n\n");
+    printf("Código\tAção\n");
+    printf("1\tJogar peça da frente da fila\n");
+    printf("2\tEnviar peça da fila para a pilha de reserva\n");
+    printf("3\tUsar peça da pilha de reserva\n");
+    printf("4\tTrocar peça da frente da fila com o topo da pilha\n");
+    printf("5\tTrocar os 3 primeiros da fila com as 3 peças da pilha\n");
+    printf("6\tDesfazer a última ação\n");
+    printf("7\tRefazer a ação desfeita\n");
+    printf("0\tSair\n\n");
+    printf("Opção escolhida: ");
+}
+
+/* Espera o Enter do jogador antes de mostrar o menu de novo */
+void pausa() {
+    if (!saidaTexto(SAIDA_NORMAL)) return;
+    printf("\nPressione Enter para continuar...");
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF) {}
+}
+
+/* Semente decimal: só dígitos e cabendo em 64 bits; senão 0 (e *semente intacta) */
+static int lerSemente(const char *texto, uint64_t *semente) {
+    if (!*texto || strspn(texto, "0123456789") != strlen(texto)) return 0;
+    errno = 0;
+    unsigned long long valor = strtoull(texto, NULL, 10);
+    if (errno == ERANGE || valor > UINT64_MAX) return 0;
+    *semente = (uint64_t) valor;
+    return 1;
+}
+
+/* --- MAIN: modos de benchmark por opção, senão o jogo interativo --- */
+int main(int argc, char *argv[]) {
+    /* ./pecas [--semente N] [--alimentador] [--quieto|--resumo] [--registros]: jogo
+       interativo; --alimentador repõe a fila a partir de uma thread produtora
+       ./pecas --bench-fila [numOps]
+       ./pecas --bench-alimentador [jogadas] [jogadores]
+       ./pecas --bench-gerador [numPecas]
+       ./pecas --bench-simulador [numAcoes] [semente]
+       ./pecas --bench-sessoes [numSessoes] [rodadas]
+       ./pecas --bench-solver [padrao] [semente] [threads] (padrão: tipos I/O/T/L, ex. "TTIL") */
+    if (argc > 1 && strcmp(argv[1], "--bench-fila") == 0) {
+        benchmarkFila(argc > 2 ? atol(argv[2]) : 100000000);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-alimentador") == 0) {
+        benchmarkAlimentador(argc > 2 ? atol(argv[2]) : 10000000, argc > 3 ? atoi(argv[3]) : 2);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-gerador") == 0) {
+        benchmarkGerador(argc > 2 ? atoll(argv[2]) : 100000000);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-simulador") == 0) {
+        uint64_t semente = 42;
+        if (argc > 3 && !lerSemente(argv[3], &semente)) {
+            fprintf(stderr, "Semente inválida: %s\nUso: %s --bench-simulador [numAcoes] [semente]\n",
+                    argv[3], argv[0]);
+            return 1;
+        }
+        benchmarkSimulador(argc > 2 ? atol(argv[2]) : 10000000, semente);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-sessoes") == 0) {
+        benchmarkSessoes(argc > 2 ? strtoull(argv[2], NULL, 10) : 1000000, argc > 3 ? atoi(argv[3]) : 20);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--bench-solver") == 0) {
+        const char *padrao = argc > 2 ? argv[2] : "TTIILLOO";
+        if (strlen(padrao) > SOLVER_PROF_MAX || strspn(padrao, "IOTL") != strlen(padrao)) {
+            fprintf(stderr, "Padrão inválido: use só I, O, T e L (até %d peças)\n", SOLVER_PROF_MAX);
+            return 1;
+        }
+        uint64_t semente = 7;
+        if (argc > 3 && !lerSemente(argv[3], &semente)) {
+            fprintf(stderr, "Semente inválida: %s\nUso: %s --bench-solver [padrao] [semente] [threads]\n",
+                    argv[3], argv[0]);
+            return 1;
+        }
+        benchmarkSolver(semente, padrao, argc > 4 ? atoi(argv[4]) : 4);
+        return 0;
+    }
+
+    int usarAlimentador = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (saidaOpcao(argv[i])) continue;
+        if (strcmp(argv[i], "--alimentador") == 0) {
+            usarAlimentador = 1;
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            uint64_t semente;
+            if (!lerSemente(argv[++i], &semente)) {
+                fprintf(stderr, "Semente inválida: %s\nUso: %s [--semente N] [--alimentador]\n", argv[i], argv[0]);
+                return 1;
+            }
+            semearPecas(semente);
+        } else {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    Fila fila;
+    Pilha pilha;
+    inicializarFila(&fila);
+    inicializarPilha(&pilha);
+    Historico hist;
+    criarHistorico(&hist, HISTORICO_CAP);
+    historico = &hist;
+    static AlimentadorPecas al;
+    if (usarAlimentador) {
+        iniciarAlimentador(&al, 0, 1, ANEL_CAP);
+        alimentador = &al;
+    }
+
+    char buffer[64];
+    int opcao = -1;
+    while (opcao != 0) {
+        exibirEstado(&fila, &pilha);
+        mostrarMenu();
+        if (!fgets(buffer, sizeof(buffer), stdin)) break;
+        opcao = atoi(buffer);
+        switch (opcao) {
+            case 1: jogarPeca(&fila); break;
+            case 2: reservarPeca(&fila, &pilha); break;
+            case 3: usarPecaReservada(&pilha); break;
+            case 4: trocarFrenteTopo(&fila, &pilha); break;
+            case 5: trocarTres(&fila, &pilha); break;
+            case 6: desfazerAcao(&fila, &pilha); break;
+            case 7: refazerAcao(&fila, &pilha); break;
+            case 0: printf("Encerrando...\n"); break;
+            default: printf("Opção inválida.\n"); break;
+        }
+        if (opcao != 0) pausa();
+    }
+
+    if (usarAlimentador) pararAlimentador(&al);
+    historico = NULL;
+    liberarHistorico(&hist);
+    liberarFila(&fila);
+    liberarPilha(&pilha);
+    return 0;
+}
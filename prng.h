@@ -0,0 +1,117 @@
+/*
+  prng.h
+  Gerador pseudoaleatório compartilhado pelos programas (xoshiro256**), no lugar de
+  srand/rand: estado explícito (um Prng por jogo, sessão ou thread), semente explícita
+  para execuções reproduzíveis e salto de 2^128 passos para fluxos paralelos que não
+  se sobrepõem.
+  - prngSemear / prngSementeDoRelogio: semente fixa ou derivada do relógio
+  - prngProximo: 64 bits; prngIntervalo / prngEntre: inteiros sem viés (no lugar de rand() % n)
+  - prngSaltar: avança 2^128 passos (copie e salte para cada thread)
+  - prngPreencher / prngPreencherIntervalo: preenchem vetores inteiros de uma vez
+  Só cabeçalho (funções static inline): basta incluir, sem mudar a linha de compilação.
+*/
+
+#ifndef PRNG_H
+#define PRNG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef struct {
+    uint64_t s[4];
+} Prng;
+
+/* splitmix64: espalha uma semente qualquer pelos 256 bits (estado nunca todo zero) */
+static inline uint64_t prngMisturar(uint64_t *x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static inline void prngSemear(Prng *g, uint64_t semente) {
+    for (int i = 0; i < 4; ++i) g->s[i] = prngMisturar(&semente);
+}
+
+/* Semente para quando não se pede reprodutibilidade (substitui srand(time(NULL))) */
+static inline uint64_t prngSementeDoRelogio(void) {
+    uint64_t x = (uint64_t) time(NULL);
+    x ^= (uint64_t) clock() << 32;
+    x ^= (uint64_t) (uintptr_t) &x; /* varia entre execuções com ASLR */
+    return prngMisturar(&x);
+}
+
+static inline uint64_t prngRotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/* xoshiro256**: próximo valor de 64 bits */
+static inline uint64_t prngProximo(Prng *g) {
+    uint64_t *s = g->s;
+    uint64_t r = prngRotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = prngRotl(s[3], 45);
+    return r;
+}
+
+/* Inteiro uniforme em [0, n) sem viés (multiplicação de Lemire: rejeita só quando a
+   parte baixa cai abaixo de 2^32 mod n, o que quase nunca acontece para n pequeno) */
+static inline uint32_t prngIntervalo(Prng *g, uint32_t n) {
+    if (n == 0) return 0;
+    uint64_t m = (prngProximo(g) >> 32) * (uint64_t) n;
+    if ((uint32_t) m < n) {
+        uint32_t limiar = (uint32_t) -n % n;
+        while ((uint32_t) m < limiar) m = (prngProximo(g) >> 32) * (uint64_t) n;
+    }
+    return (uint32_t) (m >> 32);
+}
+
+/* Inteiro uniforme em [min, max] (ex.: prngEntre(g, 1, 6) para um dado) */
+static inline int prngEntre(Prng *g, int min, int max) {
+    return min + (int) prngIntervalo(g, (uint32_t) (max - min) + 1u);
+}
+
+/* Avança o estado 2^128 passos: cópias saltadas 0, 1, 2, ... vezes geram fluxos
+   independentes (até 2^128 números cada) para threads diferentes */
+static inline void prngSaltar(Prng *g) {
+    static const uint64_t SALTO[4] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull,
+                                       0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; ++i) {
+        for (int b = 0; b < 64; ++b) {
+            if (SALTO[i] & (1ull << b)) {
+                s0 ^= g->s[0];
+                s1 ^= g->s[1];
+                s2 ^= g->s[2];
+                s3 ^= g->s[3];
+            }
+            prngProximo(g);
+        }
+    }
+    g->s[0] = s0;
+    g->s[1] = s1;
+    g->s[2] = s2;
+    g->s[3] = s3;
+}
+
+/* n valores de 64 bits; mesma sequência que n chamadas a prngProximo */
+static inline void prngPreencher(Prng *g, uint64_t *saida, size_t n) {
+    Prng local = *g; /* estado em registradores durante o laço */
+    for (size_t i = 0; i < n; ++i) saida[i] = prngProximo(&local);
+    *g = local;
+}
+
+/* n inteiros em [0, limite), mesma sequência que n chamadas a prngIntervalo */
+static inline void prngPreencherIntervalo(Prng *g, uint32_t *saida, size_t n, uint32_t limite) {
+    Prng local = *g;
+    for (size_t i = 0; i < n; ++i) saida[i] = prngIntervalo(&local, limite);
+    *g = local;
+}
+
+#endif /* PRNG_H */
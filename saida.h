@@ -0,0 +1,139 @@
+/*
+  saida.h
+  Camada de saída dos programas: níveis de verbosidade, formatação rápida de inteiros e
+  textos (sem interpretar formato como o printf) e, opcionalmente, registros em JSON
+  Lines para leitura por máquina. Tudo passa pelo stdout, então a ordem com printf se
+  mantém; em execuções não interativas o stdout ganha um buffer grande.
+  - saidaTexto(nivel) / saidaRegistros(nivel): testar ANTES de formatar, para que execuções
+    quietas ou em lote não paguem a formatação
+  - saidaStr, saidaCar, saidaInt, saidaIntLargura, saidaStrLargura: texto
+  - saidaRegistro(tipo), saidaCampoStr, saidaCampoInt, saidaFimRegistro: uma linha JSON
+  - saidaOpcao(arg): reconhece --quieto, --resumo, --detalhe e --registros
+  Só cabeçalho (funções static inline).
+*/
+
+#ifndef SAIDA_H
+#define SAIDA_H
+
+#include <stdio.h>
+#include <string.h>
+
+#define SAIDA_QUIETO 0  /* só o resultado final */
+#define SAIDA_RESUMO 1  /* eventos principais, sem o passo a passo */
+#define SAIDA_NORMAL 2  /* padrão: tudo o que o programa sempre mostrou */
+#define SAIDA_DETALHE 3
+
+#define SAIDA_TEXTO 0
+#define SAIDA_REGISTROS 1 /* uma linha JSON por evento */
+
+#define SAIDA_BUFFER (1 << 20) /* buffer do stdout em execuções não interativas */
+
+static int saidaNivel = SAIDA_NORMAL;
+static int saidaFormato = SAIDA_TEXTO;
+
+/* Programas não interativos (sem leitura do teclado entre as saídas) trocam o buffer
+   do stdout por um de SAIDA_BUFFER bytes, descarregado ao sair; chamar antes de escrever */
+static inline void saidaPreparar(int interativo) {
+    if (!interativo) setvbuf(stdout, NULL, _IOFBF, SAIDA_BUFFER);
+}
+
+/* Reconhece as opções de saída comuns; retorna 1 se arg era uma delas */
+static inline int saidaOpcao(const char *arg) {
+    if (strcmp(arg, "--quieto") == 0) saidaNivel = SAIDA_QUIETO;
+    else if (strcmp(arg, "--resumo") == 0) saidaNivel = SAIDA_RESUMO;
+    else if (strcmp(arg, "--detalhe") == 0) saidaNivel = SAIDA_DETALHE;
+    else if (strcmp(arg, "--registros") == 0) saidaFormato = SAIDA_REGISTROS;
+    else return 0;
+    return 1;
+}
+
+static inline int saidaTexto(int nivel) {
+    return saidaFormato == SAIDA_TEXTO && saidaNivel >= nivel;
+}
+
+static inline int saidaRegistros(int nivel) {
+    return saidaFormato == SAIDA_REGISTROS && saidaNivel >= nivel;
+}
+
+static inline void saidaStr(const char *s) {
+    fputs(s, stdout);
+}
+
+static inline void saidaCar(char c) {
+    putchar(c);
+}
+
+/* Inteiro em decimal, alinhado à direita em largura colunas (0 = sem alinhamento;
+   largura negativa alinha à esquerda, como %-Nd) */
+static inline void saidaIntLargura(long long v, int largura) {
+    char buf[24];
+    int i = (int) sizeof(buf);
+    unsigned long long u = v < 0 ? 0ull - (unsigned long long) v : (unsigned long long) v;
+    do {
+        buf[--i] = (char) ('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (v < 0) buf[--i] = '-';
+    int n = (int) sizeof(buf) - i;
+    if (largura > 0) for (; n < largura; ++n) putchar(' ');
+    fwrite(buf + i, 1, sizeof(buf) - (size_t) i, stdout);
+    for (; n < -largura; ++n) putchar(' ');
+}
+
+static inline void saidaInt(long long v) {
+    saidaIntLargura(v, 0);
+}
+
+/* Texto alinhado à esquerda em largura colunas (como %-Ns; conta bytes) */
+static inline void saidaStrLargura(const char *s, int largura) {
+    size_t n = strlen(s);
+    fwrite(s, 1, n, stdout);
+    for (; (int) n < largura; ++n) putchar(' ');
+}
+
+/* Texto entre aspas com o escape do JSON */
+static inline void saidaJsonStr(const char *s) {
+    putchar('"');
+    for (; *s; ++s) {
+        unsigned char c = (unsigned char) *s;
+        if (c == '"' || c == '\\') {
+            putchar('\\');
+            putchar(c);
+        } else if (c < 0x20) {
+            static const char HEX[] = "0123456789abcdef";
+            fputs("\\u00", stdout);
+            putchar(HEX[c >> 4]);
+            putchar(HEX[c & 15]);
+        } else {
+            putchar(c);
+        }
+    }
+    putchar('"');
+}
+
+static inline void saidaRegistro(const char *tipo) {
+    fputs("{\"tipo\":", stdout);
+    saidaJsonStr(tipo);
+}
+
+static inline void saidaNomeCampo(const char *nome) {
+    putchar(',');
+    saidaJsonStr(nome);
+    putchar(':');
+}
+
+static inline void saidaCampoStr(const char *nome, const char *v) {
+    saidaNomeCampo(nome);
+    saidaJsonStr(v);
+}
+
+static inline void saidaCampoInt(const char *nome, long long v) {
+    saidaNomeCampo(nome);
+    saidaInt(v);
+}
+
+static inline void saidaFimRegistro(void) {
+    fputs("}\n", stdout);
+}
+
+#endif /* SAIDA_H */
@@ -1,286 +1,648 @@
-/*
-  Sistema de priorização e montagem de componentes da torre de fuga
-  - Bubble sort por nome (string)
-  - Insertion sort por tipo (string)
-  - Selection sort por prioridade (int)
-  - Busca binária por nome (aplicável após ordenar por nome)
-  - Contagem de comparações e tempo de execução usando clock()
-  - Menu interativo e entrada via fgets
-
-*/
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
-
-#define MAX_COMPONENTES 20
-#define TAM_NOME 30
-#define TAM_TIPO 20
-
-/* Estrutura do componente */
-typedef struct {
-    char nome[TAM_NOME];
-    char tipo[TAM_TIPO];
-    int prioridade; /* 1..10 */
-} Componente;
-
-/* Protótipos */
-void cadastrarComponentes(Componente comps[], int *n);
-void mostrarComponentes(const Componente comps[], int n);
-void bubbleSortNome(Componente comps[], int n, long *comparacoes);
-void insertionSortTipo(Componente comps[], int n, long *comparacoes);
-void selectionSortPrioridade(Componente comps[], int n, long *comparacoes);
-int buscaBinariaPorNome(const Componente comps[], int n, const char chave[], long *comparacoes);
-void medirTempo(void (*algoritmo)(Componente*, int, long*), Componente comps[], int n, long *comparacoes, double *tempoSeg);
-void limpaNewline(char *s);
-
-/* --- Implementações --- */
-
-/* Limpa '\n' deixado por fgets */
-void limpaNewline(char *s) {
-    if (!s) return;
-    size_t len = strlen(s);
-    if (len > 0 && s[len-1] == '\n') s[len-1] = '\0';
-}
-
-/* Cadastro de componentes (até MAX_COMPONENTES) usando fgets */
-void cadastrarComponentes(Componente comps[], int *n) {
-    char buffer[128];
-    int quantidade = 0;
-    printf("Quantos componentes deseja cadastrar? (1-%d): ", MAX_COMPONENTES);
-    if (!fgets(buffer, sizeof(buffer), stdin)) return;
-    quantidade = atoi(buffer);
-    if (quantidade < 1) quantidade = 1;
-    if (quantidade > MAX_COMPONENTES) quantidade = MAX_COMPONENTES;
-
-    for (int i = 0; i < quantidade; ++i) {
-        printf("\nComponente %d:\n", i+1);
-        printf("  Nome (ex: chip central): ");
-        if (!fgets(comps[i].nome, sizeof(comps[i].nome), stdin)) comps[i].nome[0] = '\0';
-        limpaNewline(comps[i].nome);
-        if (strlen(comps[i].nome) == 0) strncpy(comps[i].nome, "unnamed", TAM_NOME);
-
-        printf("  Tipo (ex: controle, suporte, propulsao): ");
-        if (!fgets(comps[i].tipo, sizeof(comps[i].tipo), stdin)) comps[i].tipo[0] = '\0';
-        limpaNewline(comps[i].tipo);
-        if (strlen(comps[i].tipo) == 0) strncpy(comps[i].tipo, "generico", TAM_TIPO);
-
-        /* prioridade */
-        int p = 0;
-        while (1) {
-            printf("  Prioridade (1-10): ");
-            if (!fgets(buffer, sizeof(buffer), stdin)) break;
-            p = atoi(buffer);
-            if (p >= 1 && p <= 10) break;
-            printf("    Prioridade invalida. Tente novamente.\n");
-        }
-        comps[i].prioridade = p;
-    }
-    *n = quantidade;
-}
-
-/* Exibe os componentes formatados */
-void mostrarComponentes(const Componente comps[], int n) {
-    printf("\n--- Componentes (%d) ---\n", n);
-    printf("%-3s | %-28s | %-15s | %-9s\n", "No", "Nome", "Tipo", "Prioridade");
-    printf("----+------------------------------+-----------------+----------\n");
-    for (int i = 0; i < n; ++i) {
-        printf("%-3d | %-28s | %-15s | %-9d\n",
-               i+1, comps[i].nome, comps[i].tipo, comps[i].prioridade);
-    }
-    printf("------------------------------\n");
-}
-
-/* Bubble sort por nome (ordem lexicográfica crescente)
-   Conta comparações: uma comparação é cada strcmp entre nomes */
-void bubbleSortNome(Componente comps[], int n, long *comparacoes) {
-    *comparacoes = 0;
-    int trocou;
-    for (int i = 0; i < n-1; ++i) {
-        trocou = 0;
-        for (int j = 0; j < n-1-i; ++j) {
-            (*comparacoes)++;
-            if (strcmp(comps[j].nome, comps[j+1].nome) > 0) {
-                Componente tmp = comps[j];
-                comps[j] = comps[j+1];
-                comps[j+1] = tmp;
-                trocou = 1;
-            }
-        }
-        if (!trocou) break;
-    }
-}
-
-/* Insertion sort por tipo (string) - crescente
-   Conta comparações: cada comparação de tipo (strcmp) */
-void insertionSortTipo(Componente comps[], int n, long *comparacoes) {
-    *comparacoes = 0;
-    for (int i = 1; i < n; ++i) {
-        Componente chave = comps[i];
-        int j = i - 1;
-        /* primeiro teste: while j >=0 && comps[j].tipo > chave.tipo */
-        while (j >= 0) {
-            (*comparacoes)++;
-            if (strcmp(comps[j].tipo, chave.tipo) > 0) {
-                comps[j+1] = comps[j];
-                j--;
-            } else {
-                break;
-            }
-        }
-        comps[j+1] = chave;
-    }
-}
-
-/* Selection sort por prioridade (int) - crescente (prioridade menor -> primeiro)
-   Conta comparações: cada comparação entre prioridades */
-void selectionSortPrioridade(Componente comps[], int n, long *comparacoes) {
-    *comparacoes = 0;
-    for (int i = 0; i < n-1; ++i) {
-        int idxMin = i;
-        for (int j = i+1; j < n; ++j) {
-            (*comparacoes)++;
-            if (comps[j].prioridade < comps[idxMin].prioridade) {
-                idxMin = j;
-            }
-        }
-        if (idxMin != i) {
-            Componente tmp = comps[i];
-            comps[i] = comps[idxMin];
-            comps[idxMin] = tmp;
-        }
-    }
-}
-
-/* Busca binária por nome (assume vetor ordenado por nome, crescente)
-   Retorna índice (0..n-1) se encontrado, -1 caso contrário.
-   Conta comparações: cada strcmp com o elemento do meio conta como 1. */
-int buscaBinariaPorNome(const Componente comps[], int n, const char chave[], long *comparacoes) {
-    int left = 0, right = n - 1;
-    *comparacoes = 0;
-    while (left <= right) {
-        int mid = left + (right - left) / 2;
-        (*comparacoes)++;
-        int cmp = strcmp(comps[mid].nome, chave);
-        if (cmp == 0) return mid;
-        else if (cmp < 0) left = mid + 1;
-        else right = mid - 1;
-    }
-    return -1;
-}
-
-/* medirTempo: recebe uma função de ordenação (com assinatura (Componente*,int,long*))
-   e executa medição de tempo em segundos e retorna comparações via ponteiro. */
-void medirTempo(void (*algoritmo)(Componente*, int, long*), Componente comps[], int n, long *comparacoes, double *tempoSeg) {
-    clock_t inicio = clock();
-    algoritmo(comps, n, comparacoes);
-    clock_t fim = clock();
-    *tempoSeg = (double)(fim - inicio) / CLOCKS_PER_SEC;
-}
-
-/* --- Função principal com menu interativo --- */
-int main(void) {
-    Componente componentes[MAX_COMPONENTES];
-    Componente copia[MAX_COMPONENTES]; /* cópia para permitir reordenações sem perder entrada original */
-    int n = 0;
-    char buffer[128];
-
-    printf("=== Montagem da Torre de Fuga - Módulo de Priorização ===\n\n");
-
-    /* Cadastro */
-    cadastrarComponentes(componentes, &n);
-    /* copia para estado original */
-    for (int i = 0; i < n; ++i) copia[i] = componentes[i];
-
-    int escolha;
-    int ordenadoPorNome = 0; /* flag para permitir busca binária apenas se ordenado por nome */
-
-    do {
-        printf("\nMenu:\n");
-        printf(" 1 - Mostrar componentes (estado atual)\n");
-        printf(" 2 - Ordenar por NOME (Bubble Sort)\n");
-        printf(" 3 - Ordenar por TIPO (Insertion Sort)\n");
-        printf(" 4 - Ordenar por PRIORIDADE (Selection Sort)\n");
-        printf(" 5 - Buscar componente-chave por NOME (busca binária) [requer ordenacao por NOME]\n");
-        printf(" 6 - Resetar para entrada original\n");
-        printf(" 0 - Sair\n");
-        printf("Escolha uma opcao: ");
-        if (!fgets(buffer, sizeof(buffer), stdin)) break;
-        escolha = atoi(buffer);
-
-        if (escolha == 1) {
-            mostrarComponentes(componentes, n);
-        } else if (escolha == 2) {
-            /* ordena por nome usando bubble sort */
-            /* faz cópia para operar sem perder a ordem anterior? aqui modificamos o vetor atual */
-            long comps = 0;
-            double tempo = 0.0;
-            medirTempo(bubbleSortNome, componentes, n, &comps, &tempo);
-            printf("\n[Bubble Sort por NOME] Comparacoes: %ld | Tempo: %.6f s\n", comps, tempo);
-            mostrarComponentes(componentes, n);
-            ordenadoPorNome = 1;
-        } else if (escolha == 3) {
-            long comps = 0;
-            double tempo = 0.0;
-            medirTempo(insertionSortTipo, componentes, n, &comps, &tempo);
-            printf("\n[Insertion Sort por TIPO] Comparacoes: %ld | Tempo: %.6f s\n", comps, tempo);
-            mostrarComponentes(componentes, n);
-            ordenadoPorNome = 0;
-        } else if (escolha == 4) {
-            long comps = 0;
-            double tempo = 0.0;
-            medirTempo(selectionSortPrioridade, componentes, n, &comps, &tempo);
-            printf("\n[Selection Sort por PRIORIDADE] Comparacoes: %ld | Tempo: %.6f s\n", comps, tempo);
-            mostrarComponentes(componentes, n);
-            ordenadoPorNome = 0;
-        } else if (escolha == 5) {
-            if (!ordenadoPorNome) {
-                printf("\nERRO: A busca binaria por nome exige que os componentes estejam ordenados por NOME (Bubble Sort). Deseja ordenar agora? (s/n): ");
-                if (!fgets(buffer, sizeof(buffer), stdin)) break;
-                if (buffer[0] == 's' || buffer[0] == 'S') {
-                    long comps = 0;
-                    double tempo = 0.0;
-                    medirTempo(bubbleSortNome, componentes, n, &comps, &tempo);
-                    printf("\n[Bubble Sort por NOME] Comparacoes: %ld | Tempo: %.6f s\n", comps, tempo);
-                    mostrarComponentes(componentes, n);
-                    ordenadoPorNome = 1;
-                } else {
-                    printf("Busca cancelada. Ordene por nome antes de usar a busca binaria.\n");
-                    continue;
-                }
-            }
-
-            printf("Digite o NOME exato do componente a buscar: ");
-            if (!fgets(buffer, sizeof(buffer), stdin)) break;
-            limpaNewline(buffer);
-            if (strlen(buffer) == 0) {
-                printf("Nome vazio. Abortando busca.\n");
-                continue;
-            }
-            long compsBusca = 0;
-            int idx = buscaBinariaPorNome(componentes, n, buffer, &compsBusca);
-            printf("Comparacoes na busca binaria: %ld\n", compsBusca);
-            if (idx >= 0) {
-                printf("Componente encontrado na posicao %d:\n", idx+1);
-                printf("  Nome: %s\n  Tipo: %s\n  Prioridade: %d\n",
-                       componentes[idx].nome, componentes[idx].tipo, componentes[idx].prioridade);
-                printf("\n>> Componente-chave presente: ativacao possivel!\n");
-            } else {
-                printf("Componente '%s' NAO encontrado no vetor.\n", buffer);
-            }
-        } else if (escolha == 6) {
-            /* restaurar do backup */
-            for (int i = 0; i < n; ++i) componentes[i] = copia[i];
-            ordenadoPorNome = 0;
-            printf("Estado restaurado para os dados de entrada originais.\n");
-        } else if (escolha == 0) {
-            printf("Saindo...\n");
-        } else {
-            printf("Opcao invalida.\n");
-        }
-
-    } while (escolha != 0);
-
-    return 0;
-}
+/*
+  Sistema de priorização e montagem de componentes da torre de fuga
+  - Bubble sort por nome (string)
+  - Insertion sort por tipo (string)
+  - Selection sort por prioridade (int)
+  - Busca binária por nome (aplicável após ordenar por nome)
+  - Top-K por prioridade com heap (ordenação parcial, O(n log K))
+  - Fila de montagem (heap 4-ário) com chegadas/conclusões em fluxo
+  - Contagem de comparações e tempo de execução usando clock()
+  - Menu interativo e entrada via fgets
+  - Instrumentação opcional (instr.h): gcc ... -DINSTRUMENTAR
+  - Saída (saida.h): --resumo omite o menu e as listagens após ordenar, --quieto também
+    os resumos; --registros troca listagens e resumos por linhas JSON
+
+*/
+
+#define _POSIX_C_SOURCE 200809L /* clock_gettime em -std=c11 */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "instr.h"
+#include "saida.h"
+
+#define MAX_COMPONENTES 20
+#define TAM_NOME 30
+#define TAM_TIPO 20
+#define ARIDADE_FILA 4 /* filhos por nó no heap da fila de montagem */
+
+/* Estrutura do componente */
+typedef struct {
+    char nome[TAM_NOME];
+    char tipo[TAM_TIPO];
+    int prioridade; /* 1..10 */
+} Componente;
+
+/* Fila de montagem: heap 4-ário (mínimo por prioridade) com handles estáveis,
+   permitindo chegadas, conclusões e mudanças de prioridade sem reordenar tudo. */
+typedef struct {
+    Componente *itens; /* heap: itens[0] é o mais urgente */
+    int *handleDe;     /* posição no heap -> handle */
+    int *posicaoDe;    /* handle -> posição no heap (-1 se ausente) */
+    int *livres;       /* pilha de handles liberados para reuso */
+    int tamanho;
+    int capacidade;
+    int numHandles;    /* handles já emitidos */
+    int numLivres;
+    long comparacoes;  /* acumulado desde a criação */
+} FilaMontagem;
+
+/* Protótipos */
+void lerComponente(Componente *c);
+void cadastrarComponentes(Componente comps[], int *n);
+void mostrarComponentes(const Componente comps[], int n);
+void bubbleSortNome(Componente comps[], int n, long *comparacoes);
+void insertionSortTipo(Componente comps[], int n, long *comparacoes);
+void selectionSortPrioridade(Componente comps[], int n, long *comparacoes);
+int buscaBinariaPorNome(const Componente comps[], int n, const char chave[], long *comparacoes);
+int topKPrioridade(const Componente comps[], int n, int k, Componente saida[], long *comparacoes);
+void inicializarFilaMontagem(FilaMontagem *fm);
+void liberarFilaMontagem(FilaMontagem *fm);
+int chegadaComponente(FilaMontagem *fm, const Componente *c);
+int conclusaoComponente(FilaMontagem *fm, int handle);
+int atualizarPrioridade(FilaMontagem *fm, int handle, int prioridade);
+int retirarProximo(FilaMontagem *fm, Componente *saida);
+int buscarHandlePorNome(const FilaMontagem *fm, const char nome[]);
+void menuFilaMontagem(FilaMontagem *fm, const Componente comps[], int n);
+void medirTempo(void (*algoritmo)(Componente*, int, long*), Componente comps[], int n, long *comparacoes, double *tempoSeg);
+void limpaNewline(char *s);
+
+/* --- Implementações --- */
+
+/* Limpa '\n' deixado por fgets */
+void limpaNewline(char *s) {
+    if (!s) return;
+    size_t len = strlen(s);
+    if (len > 0 && s[len-1] == '\n') s[len-1] = '\0';
+}
+
+/* Lê um componente (nome, tipo, prioridade) via fgets */
+void lerComponente(Componente *c) {
+    char buffer[128];
+    printf("  Nome (ex: chip central): ");
+    if (!fgets(c->nome, sizeof(c->nome), stdin)) c->nome[0] = '\0';
+    limpaNewline(c->nome);
+    if (strlen(c->nome) == 0) strncpy(c->nome, "unnamed", TAM_NOME);
+
+    printf("  Tipo (ex: controle, suporte, propulsao): ");
+    if (!fgets(c->tipo, sizeof(c->tipo), stdin)) c->tipo[0] = '\0';
+    limpaNewline(c->tipo);
+    if (strlen(c->tipo) == 0) strncpy(c->tipo, "generico", TAM_TIPO);
+
+    /* prioridade */
+    int p = 0;
+    while (1) {
+        printf("  Prioridade (1-10): ");
+        if (!fgets(buffer, sizeof(buffer), stdin)) break;
+        p = atoi(buffer);
+        if (p >= 1 && p <= 10) break;
+        printf("    Prioridade invalida. Tente novamente.\n");
+    }
+    c->prioridade = p;
+}
+
+/* Cadastro de componentes (até MAX_COMPONENTES) usando fgets */
+void cadastrarComponentes(Componente comps[], int *n) {
+    char buffer[128];
+    int quantidade = 0;
+    printf("Quantos componentes deseja cadastrar? (1-%d): ", MAX_COMPONENTES);
+    if (!fgets(buffer, sizeof(buffer), stdin)) return;
+    quantidade = atoi(buffer);
+    if (quantidade < 1) quantidade = 1;
+    if (quantidade > MAX_COMPONENTES) quantidade = MAX_COMPONENTES;
+
+    for (int i = 0; i < quantidade; ++i) {
+        printf("\nComponente %d:\n", i+1);
+        lerComponente(&comps[i]);
+    }
+    *n = quantidade;
+}
+
+/* Exibe os componentes formatados (ou um registro "componente" por linha com --registros) */
+void mostrarComponentes(const Componente comps[], int n) {
+    if (saidaFormato == SAIDA_REGISTROS) {
+        for (int i = 0; i < n; ++i) {
+            saidaRegistro("componente");
+            saidaCampoInt("posicao", i + 1);
+            saidaCampoStr("nome", comps[i].nome);
+            saidaCampoStr("categoria", comps[i].tipo); /* "tipo" já nomeia o registro */
+            saidaCampoInt("prioridade", comps[i].prioridade);
+            saidaFimRegistro();
+        }
+        return;
+    }
+    saidaStr("\n--- Componentes (");
+    saidaInt(n);
+    saidaStr(") ---\n");
+    saidaStr("No  | Nome                         | Tipo            | Prioridade\n");
+    saidaStr("----+------------------------------+-----------------+----------\n");
+    for (int i = 0; i < n; ++i) {
+        saidaIntLargura(i + 1, -3);
+        saidaStr(" | ");
+        saidaStrLargura(comps[i].nome, 28);
+        saidaStr(" | ");
+        saidaStrLargura(comps[i].tipo, 15);
+        saidaStr(" | ");
+        saidaIntLargura(comps[i].prioridade, -9);
+        saidaCar('\n');
+    }
+    saidaStr("------------------------------\n");
+}
+
+/* Resultado de uma ordenação (ou do Top-K): resumo no nível resumo, listagem no normal */
+static void relatarOrdenacao(const char *rotulo, long comparacoes, double tempo, const Componente comps[], int n) {
+    if (saidaTexto(SAIDA_RESUMO))
+        printf("\n[%s] Comparacoes: %ld | Tempo: %.6f s\n", rotulo, comparacoes, tempo);
+    if (saidaRegistros(SAIDA_RESUMO)) {
+        saidaRegistro("ordenacao");
+        saidaCampoStr("algoritmo", rotulo);
+        saidaCampoInt("comparacoes", comparacoes);
+        saidaCampoInt("tempoUs", (long long) (tempo * 1e6));
+        saidaFimRegistro();
+    }
+    if (saidaTexto(SAIDA_NORMAL) || saidaRegistros(SAIDA_NORMAL)) mostrarComponentes(comps, n);
+}
+
+/* Bubble sort por nome (ordem lexicográfica crescente)
+   Conta comparações: uma comparação é cada strcmp entre nomes */
+void bubbleSortNome(Componente comps[], int n, long *comparacoes) {
+    *comparacoes = 0;
+    int trocou;
+    for (int i = 0; i < n-1; ++i) {
+        trocou = 0;
+        for (int j = 0; j < n-1-i; ++j) {
+            (*comparacoes)++;
+            if (strcmp(comps[j].nome, comps[j+1].nome) > 0) {
+                Componente tmp = comps[j];
+                comps[j] = comps[j+1];
+                comps[j+1] = tmp;
+                trocou = 1;
+            }
+        }
+        if (!trocou) break;
+    }
+}
+
+/* Insertion sort por tipo (string) - crescente
+   Conta comparações: cada comparação de tipo (strcmp) */
+void insertionSortTipo(Componente comps[], int n, long *comparacoes) {
+    *comparacoes = 0;
+    for (int i = 1; i < n; ++i) {
+        Componente chave = comps[i];
+        int j = i - 1;
+        /* primeiro teste: while j >=0 && comps[j].tipo > chave.tipo */
+        while (j >= 0) {
+            (*comparacoes)++;
+            if (strcmp(comps[j].tipo, chave.tipo) > 0) {
+                comps[j+1] = comps[j];
+                j--;
+            } else {
+                break;
+            }
+        }
+        comps[j+1] = chave;
+    }
+}
+
+/* Selection sort por prioridade (int) - crescente (prioridade menor -> primeiro)
+   Conta comparações: cada comparação entre prioridades */
+void selectionSortPrioridade(Componente comps[], int n, long *comparacoes) {
+    *comparacoes = 0;
+    for (int i = 0; i < n-1; ++i) {
+        int idxMin = i;
+        for (int j = i+1; j < n; ++j) {
+            (*comparacoes)++;
+            if (comps[j].prioridade < comps[idxMin].prioridade) {
+                idxMin = j;
+            }
+        }
+        if (idxMin != i) {
+            Componente tmp = comps[i];
+            comps[i] = comps[idxMin];
+            comps[idxMin] = tmp;
+        }
+    }
+}
+
+/* Busca binária por nome (assume vetor ordenado por nome, crescente)
+   Retorna índice (0..n-1) se encontrado, -1 caso contrário.
+   Conta comparações: cada strcmp com o elemento do meio conta como 1. */
+int buscaBinariaPorNome(const Componente comps[], int n, const char chave[], long *comparacoes) {
+    int left = 0, right = n - 1, achado = -1;
+    *comparacoes = 0;
+    INSTR_TEMPO_INICIO(tBusca, "torre.buscaBinaria.ns");
+    while (left <= right) {
+        int mid = left + (right - left) / 2;
+        (*comparacoes)++;
+        int cmp = strcmp(comps[mid].nome, chave);
+        if (cmp == 0) {
+            achado = mid;
+            break;
+        }
+        else if (cmp < 0) left = mid + 1;
+        else right = mid - 1;
+    }
+    INSTR_TEMPO_FIM(tBusca);
+    INSTR_HISTOGRAMA("torre.buscaBinaria.comparacoes", *comparacoes);
+    return achado;
+}
+
+/* Desce o elemento da posição i num max-heap binário por prioridade (raiz = menos urgente).
+   Conta comparações: cada comparação entre prioridades conta como 1. */
+static void descerMaxHeap(Componente heap[], int n, int i, long *comparacoes) {
+    while (1) {
+        int maior = i;
+        int esq = 2*i + 1, dir = 2*i + 2;
+        if (esq < n) {
+            (*comparacoes)++;
+            if (heap[esq].prioridade > heap[maior].prioridade) maior = esq;
+        }
+        if (dir < n) {
+            (*comparacoes)++;
+            if (heap[dir].prioridade > heap[maior].prioridade) maior = dir;
+        }
+        if (maior == i) return;
+        Componente tmp = heap[i];
+        heap[i] = heap[maior];
+        heap[maior] = tmp;
+        i = maior;
+    }
+}
+
+/* Top-K por prioridade (ordenação parcial, O(n log K))
+   Copia em saida[] os K componentes mais urgentes (menor prioridade primeiro), em ordem
+   crescente, sem alterar comps[]. Mantém um max-heap com os K melhores vistos até agora:
+   cada novo componente só entra se for mais urgente que a raiz.
+   Retorna quantos componentes foram escritos (min(k, n)). */
+int topKPrioridade(const Componente comps[], int n, int k, Componente saida[], long *comparacoes) {
+    *comparacoes = 0;
+    if (k > n) k = n;
+    if (k <= 0) return 0;
+
+    for (int i = 0; i < k; ++i) saida[i] = comps[i];
+    for (int i = k/2 - 1; i >= 0; --i) descerMaxHeap(saida, k, i, comparacoes);
+
+    for (int i = k; i < n; ++i) {
+        (*comparacoes)++;
+        if (comps[i].prioridade < saida[0].prioridade) {
+            saida[0] = comps[i];
+            descerMaxHeap(saida, k, 0, comparacoes);
+        }
+    }
+
+    /* heapsort dos K selecionados: retira a raiz (maior) para o fim */
+    for (int fim = k - 1; fim > 0; --fim) {
+        Componente tmp = saida[0];
+        saida[0] = saida[fim];
+        saida[fim] = tmp;
+        descerMaxHeap(saida, fim, 0, comparacoes);
+    }
+    return k;
+}
+
+/* --- Fila de montagem (heap 4-ário, mínimo por prioridade) --- */
+
+void inicializarFilaMontagem(FilaMontagem *fm) {
+    fm->itens = NULL;
+    fm->handleDe = NULL;
+    fm->posicaoDe = NULL;
+    fm->livres = NULL;
+    fm->tamanho = fm->capacidade = 0;
+    fm->numHandles = fm->numLivres = 0;
+    fm->comparacoes = 0;
+}
+
+void liberarFilaMontagem(FilaMontagem *fm) {
+    free(fm->itens);
+    free(fm->handleDe);
+    free(fm->posicaoDe);
+    free(fm->livres);
+    inicializarFilaMontagem(fm);
+}
+
+/* Coloca o item/handle na posição pos e atualiza o índice handle -> posição */
+static void colocarNaFila(FilaMontagem *fm, int pos, Componente c, int handle) {
+    fm->itens[pos] = c;
+    fm->handleDe[pos] = handle;
+    fm->posicaoDe[handle] = pos;
+}
+
+static void subirFila(FilaMontagem *fm, int pos) {
+    Componente c = fm->itens[pos];
+    int h = fm->handleDe[pos];
+    while (pos > 0) {
+        int pai = (pos - 1) / ARIDADE_FILA;
+        fm->comparacoes++;
+        if (fm->itens[pai].prioridade <= c.prioridade) break;
+        colocarNaFila(fm, pos, fm->itens[pai], fm->handleDe[pai]);
+        pos = pai;
+    }
+    colocarNaFila(fm, pos, c, h);
+}
+
+static void descerFila(FilaMontagem *fm, int pos) {
+    Componente c = fm->itens[pos];
+    int h = fm->handleDe[pos];
+    while (1) {
+        int primeiro = pos * ARIDADE_FILA + 1;
+        if (primeiro >= fm->tamanho) break;
+        int ultimo = primeiro + ARIDADE_FILA;
+        if (ultimo > fm->tamanho) ultimo = fm->tamanho;
+        int menor = primeiro;
+        for (int f = primeiro + 1; f < ultimo; ++f) {
+            fm->comparacoes++;
+            if (fm->itens[f].prioridade < fm->itens[menor].prioridade) menor = f;
+        }
+        fm->comparacoes++;
+        if (fm->itens[menor].prioridade >= c.prioridade) break;
+        colocarNaFila(fm, pos, fm->itens[menor], fm->handleDe[menor]);
+        pos = menor;
+    }
+    colocarNaFila(fm, pos, c, h);
+}
+
+/* Remove o item da posição pos, recolocando o último elemento no lugar */
+static void removerDaFila(FilaMontagem *fm, int pos) {
+    int h = fm->handleDe[pos];
+    fm->posicaoDe[h] = -1;
+    fm->livres[fm->numLivres++] = h;
+    fm->tamanho--;
+    if (pos == fm->tamanho) return;
+    colocarNaFila(fm, pos, fm->itens[fm->tamanho], fm->handleDe[fm->tamanho]);
+    if (pos > 0) fm->comparacoes++; /* comparação com o pai, contada como em subirFila */
+    if (pos > 0 && fm->itens[(pos - 1) / ARIDADE_FILA].prioridade > fm->itens[pos].prioridade)
+        subirFila(fm, pos);
+    else
+        descerFila(fm, pos);
+}
+
+/* chegadaComponente: insere um componente na fila e retorna seu handle (-1 se sem memória) */
+int chegadaComponente(FilaMontagem *fm, const Componente *c) {
+    if (fm->tamanho == fm->capacidade) {
+        int novaCap = fm->capacidade ? fm->capacidade * 2 : MAX_COMPONENTES;
+        Componente *itens = (Componente*) realloc(fm->itens, novaCap * sizeof(Componente));
+        if (!itens) return -1;
+        fm->itens = itens;
+        int *handleDe = (int*) realloc(fm->handleDe, novaCap * sizeof(int));
+        if (!handleDe) return -1;
+        fm->handleDe = handleDe;
+        int *posicaoDe = (int*) realloc(fm->posicaoDe, novaCap * sizeof(int));
+        if (!posicaoDe) return -1;
+        fm->posicaoDe = posicaoDe;
+        int *livres = (int*) realloc(fm->livres, novaCap * sizeof(int));
+        if (!livres) return -1;
+        fm->livres = livres;
+        fm->capacidade = novaCap;
+    }
+    /* handles vivos nunca excedem a capacidade, então posicaoDe[] sempre comporta o novo */
+    int h = fm->numLivres > 0 ? fm->livres[--fm->numLivres] : fm->numHandles++;
+    int pos = fm->tamanho++;
+    colocarNaFila(fm, pos, *c, h);
+    subirFila(fm, pos);
+    return h;
+}
+
+/* conclusaoComponente: remove o componente identificado por handle. Retorna 1 se removido. */
+int conclusaoComponente(FilaMontagem *fm, int handle) {
+    if (handle < 0 || handle >= fm->numHandles || fm->posicaoDe[handle] < 0) return 0;
+    removerDaFila(fm, fm->posicaoDe[handle]);
+    return 1;
+}
+
+/* atualizarPrioridade: muda a prioridade de um componente na fila, mantendo a ordem. */
+int atualizarPrioridade(FilaMontagem *fm, int handle, int prioridade) {
+    if (handle < 0 || handle >= fm->numHandles || fm->posicaoDe[handle] < 0) return 0;
+    int pos = fm->posicaoDe[handle];
+    int antiga = fm->itens[pos].prioridade;
+    fm->itens[pos].prioridade = prioridade;
+    if (prioridade < antiga) subirFila(fm, pos);
+    else if (prioridade > antiga) descerFila(fm, pos);
+    return 1;
+}
+
+/* retirarProximo: remove o componente mais urgente e o copia em saida. Retorna 0 se vazia. */
+int retirarProximo(FilaMontagem *fm, Componente *saida) {
+    if (fm->tamanho == 0) return 0;
+    if (saida) *saida = fm->itens[0];
+    removerDaFila(fm, 0);
+    return 1;
+}
+
+/* buscarHandlePorNome: busca linear (uso no menu); retorna -1 se não encontrado */
+int buscarHandlePorNome(const FilaMontagem *fm, const char nome[]) {
+    for (int i = 0; i < fm->tamanho; ++i)
+        if (strcmp(fm->itens[i].nome, nome) == 0) return fm->handleDe[i];
+    return -1;
+}
+
+/* Submenu da fila de montagem: chegadas, conclusões e consulta dos próximos K */
+void menuFilaMontagem(FilaMontagem *fm, const Componente comps[], int n) {
+    char buffer[128];
+    while (1) {
+        printf("\nFila de montagem (%d na fila, %ld comparacoes acumuladas):\n", fm->tamanho, fm->comparacoes);
+        printf(" i - Importar componentes cadastrados\n");
+        printf(" a - Chegada de novo componente\n");
+        printf(" c - Conclusao de componente (por NOME)\n");
+        printf(" p - Alterar prioridade (por NOME)\n");
+        printf(" r - Retirar o proximo para montagem\n");
+        printf(" k - Mostrar os K proximos\n");
+        printf(" 0 - Voltar\n");
+        printf("Escolha: ");
+        if (!fgets(buffer, sizeof(buffer), stdin)) return;
+        char op = buffer[0];
+
+        if (op == '0') {
+            return;
+        } else if (op == 'i') {
+            int importados = 0;
+            for (int i = 0; i < n; ++i)
+                if (chegadaComponente(fm, &comps[i]) >= 0) importados++;
+            printf("%d componente(s) importado(s).\n", importados);
+            if (importados < n) printf("Sem memoria para a fila: %d componente(s) de fora.\n", n - importados);
+        } else if (op == 'a') {
+            Componente c;
+            lerComponente(&c);
+            if (chegadaComponente(fm, &c) < 0) printf("Sem memoria para a fila.\n");
+        } else if (op == 'c' || op == 'p') {
+            printf("Nome do componente: ");
+            if (!fgets(buffer, sizeof(buffer), stdin)) return;
+            limpaNewline(buffer);
+            int h = buscarHandlePorNome(fm, buffer);
+            if (h < 0) {
+                printf("Componente '%s' nao esta na fila.\n", buffer);
+                continue;
+            }
+            if (op == 'c') {
+                conclusaoComponente(fm, h);
+                printf("Componente '%s' concluido.\n", buffer);
+            } else {
+                printf("Nova prioridade (1-10): ");
+                if (!fgets(buffer, sizeof(buffer), stdin)) return;
+                int p = atoi(buffer);
+                if (p < 1 || p > 10) {
+                    printf("Prioridade invalida.\n");
+                    continue;
+                }
+                atualizarPrioridade(fm, h, p);
+            }
+        } else if (op == 'r') {
+            Componente c;
+            if (retirarProximo(fm, &c))
+                printf("Proximo para montagem: %s (%s, prioridade %d)\n", c.nome, c.tipo, c.prioridade);
+            else
+                printf("Fila vazia.\n");
+        } else if (op == 'k') {
+            printf("Quantos (K)? ");
+            if (!fgets(buffer, sizeof(buffer), stdin)) return;
+            int k = atoi(buffer);
+            Componente *saida = (Componente*) malloc((fm->tamanho > 0 ? fm->tamanho : 1) * sizeof(Componente));
+            if (!saida) return;
+            long comparacoes = 0;
+            int m = topKPrioridade(fm->itens, fm->tamanho, k, saida, &comparacoes);
+            printf("[Top-K sobre a fila] Comparacoes: %ld\n", comparacoes);
+            mostrarComponentes(saida, m);
+            free(saida);
+        } else {
+            printf("Opcao invalida.\n");
+        }
+    }
+}
+
+/* medirTempo: recebe uma função de ordenação (com assinatura (Componente*,int,long*))
+   e executa medição de tempo em segundos e retorna comparações via ponteiro. */
+void medirTempo(void (*algoritmo)(Componente*, int, long*), Componente comps[], int n, long *comparacoes, double *tempoSeg) {
+    clock_t inicio = clock();
+    INSTR_TEMPO_INICIO(tOrdenacao, "torre.ordenacao.ns");
+    algoritmo(comps, n, comparacoes);
+    INSTR_TEMPO_FIM(tOrdenacao);
+    clock_t fim = clock();
+    INSTR_HISTOGRAMA("torre.ordenacao.comparacoes", *comparacoes);
+    *tempoSeg = (double)(fim - inicio) / CLOCKS_PER_SEC;
+}
+
+/* --- Função principal com menu interativo --- */
+int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i)
+        if (!saidaOpcao(argv[i])) fprintf(stderr, "Opcao ignorada: %s\n", argv[i]);
+
+    Componente componentes[MAX_COMPONENTES];
+    Componente copia[MAX_COMPONENTES]; /* cópia para permitir reordenações sem perder entrada original */
+    int n = 0;
+    char buffer[128];
+
+    printf("=== Montagem da Torre de Fuga - Módulo de Priorização ===\n\n");
+
+    /* Cadastro */
+    cadastrarComponentes(componentes, &n);
+    /* copia para estado original */
+    for (int i = 0; i < n; ++i) copia[i] = componentes[i];
+
+    int escolha;
+    int ordenadoPorNome = 0; /* flag para permitir busca binária apenas se ordenado por nome */
+    FilaMontagem filaMontagem;
+    inicializarFilaMontagem(&filaMontagem);
+
+    do {
+        if (saidaTexto(SAIDA_NORMAL)) {
+            saidaStr("\nMenu:\n"
+                     " 1 - Mostrar componentes (estado atual)\n"
+                     " 2 - Ordenar por NOME (Bubble Sort)\n"
+                     " 3 - Ordenar por TIPO (Insertion Sort)\n"
+                     " 4 - Ordenar por PRIORIDADE (Selection Sort)\n"
+                     " 5 - Buscar componente-chave por NOME (busca binária) [requer ordenacao por NOME]\n"
+                     " 6 - Resetar para entrada original\n"
+                     " 7 - Mostrar os K mais urgentes (Top-K com heap)\n"
+                     " 8 - Fila de montagem (chegadas/conclusoes)\n"
+                     " 0 - Sair\n"
+                     "Escolha uma opcao: ");
+        }
+        if (!fgets(buffer, sizeof(buffer), stdin)) break;
+        escolha = atoi(buffer);
+
+        if (escolha == 1) {
+            mostrarComponentes(componentes, n);
+        } else if (escolha == 2) {
+            /* ordena por nome usando bubble sort */
+            /* faz cópia para operar sem perder a ordem anterior? aqui modificamos o vetor atual */
+            long comps = 0;
+            double tempo = 0.0;
+            medirTempo(bubbleSortNome, componentes, n, &comps, &tempo);
+            relatarOrdenacao("Bubble Sort por NOME", comps, tempo, componentes, n);
+            ordenadoPorNome = 1;
+        } else if (escolha == 3) {
+            long comps = 0;
+            double tempo = 0.0;
+            medirTempo(insertionSortTipo, componentes, n, &comps, &tempo);
+            relatarOrdenacao("Insertion Sort por TIPO", comps, tempo, componentes, n);
+            ordenadoPorNome = 0;
+        } else if (escolha == 4) {
+            long comps = 0;
+            double tempo = 0.0;
+            medirTempo(selectionSortPrioridade, componentes, n, &comps, &tempo);
+            relatarOrdenacao("Selection Sort por PRIORIDADE", comps, tempo, componentes, n);
+            ordenadoPorNome = 0;
+        } else if (escolha == 5) {
+            if (!ordenadoPorNome) {
+                printf("\nERRO: A busca binaria por nome exige que os componentes estejam ordenados por NOME (Bubble Sort). Deseja ordenar agora? (s/n): ");
+                if (!fgets(buffer, sizeof(buffer), stdin)) break;
+                if (buffer[0] == 's' || buffer[0] == 'S') {
+                    long comps = 0;
+                    double tempo = 0.0;
+                    medirTempo(bubbleSortNome, componentes, n, &comps, &tempo);
+                    relatarOrdenacao("Bubble Sort por NOME", comps, tempo, componentes, n);
+                    ordenadoPorNome = 1;
+                } else {
+                    printf("Busca cancelada. Ordene por nome antes de usar a busca binaria.\n");
+                    continue;
+                }
+            }
+
+            printf("Digite o NOME exato do componente a buscar: ");
+            if (!fgets(buffer, sizeof(buffer), stdin)) break;
+            limpaNewline(buffer);
+            if (strlen(buffer) == 0) {
+                printf("Nome vazio. Abortando busca.\n");
+                continue;
+            }
+            long compsBusca = 0;
+            int idx = buscaBinariaPorNome(componentes, n, buffer, &compsBusca);
+            printf("Comparacoes na busca binaria: %ld\n", compsBusca);
+            if (idx >= 0) {
+                printf("Componente encontrado na posicao %d:\n", idx+1);
+                printf("  Nome: %s\n  Tipo: %s\n  Prioridade: %d\n",
+                       componentes[idx].nome, componentes[idx].tipo, componentes[idx].prioridade);
+                printf("\n>> Componente-chave presente: ativacao possivel!\n");
+            } else {
+                printf("Componente '%s' NAO encontrado no vetor.\n", buffer);
+            }
+        } else if (escolha == 6) {
+            /* restaurar do backup */
+            for (int i = 0; i < n; ++i) componentes[i] = copia[i];
+            ordenadoPorNome = 0;
+            printf("Estado restaurado para os dados de entrada originais.\n");
+        } else if (escolha == 7) {
+            printf("Quantos componentes (K)? ");
+            if (!fgets(buffer, sizeof(buffer), stdin)) break;
+            int k = atoi(buffer);
+            Componente topK[MAX_COMPONENTES];
+            long comps = 0;
+            clock_t inicio = clock();
+            int m = topKPrioridade(componentes, n, k, topK, &comps);
+            double tempo = (double)(clock() - inicio) / CLOCKS_PER_SEC;
+            relatarOrdenacao("Top-K por PRIORIDADE (heap)", comps, tempo, topK, m);
+        } else if (escolha == 8) {
+            menuFilaMontagem(&filaMontagem, componentes, n);
+        } else if (escolha == 0) {
+            printf("Saindo...\n");
+        } else {
+            printf("Opcao invalida.\n");
+        }
+
+    } while (escolha != 0);
+
+    liberarFilaMontagem(&filaMontagem);
+    return 0;
+}
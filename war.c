@@ -1,297 +1,633 @@
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
-
-#define MAX_TERR 10
-#define MAX_MISSOES 6
-
-/* Estrutura de território */
-typedef struct {
-    char nome[30];
-    char cor[10];  /* dono: "vermelho", "azul", "neutro" */
-    int tropas;
-} Territorio;
-
-/* --- Prototipos --- */
-void atribuirMissao(char* destino, char* missoes[], int totalMissoes);
-int verificarMissao(char* missao, Territorio* mapa, int tamanho);
-void exibirMissao(const char* missao); /* passagem por valor (pointer passado por valor) */
-void atacar(Territorio* atacante, Territorio* defensor);
-void exibirMapa(Territorio* mapa, int tamanho);
-void liberarMemoria(Territorio* mapa, char** missoesJogadores, int numPlayers);
-
-/* Variável global que informa a cor do jogador atual para a função verificarMissao
-   (seguindo a assinatura pedida verificarMissao(char*, Territorio*, int)). */
-char jogadorAtualCor[10];
-
-/* --- Implementações --- */
-
-/* Escolhe aleatoriamente uma missão do vetor e copia para destino (destino deve estar alocado) */
-void atribuirMissao(char* destino, char* missoes[], int totalMissoes) {
-    int idx = rand() % totalMissoes;
-    strcpy(destino, missoes[idx]); /* cópia conforme requisitado */
-}
-
-/* Exibe a missão (passagem por valor no sentido de não modificar) */
-void exibirMissao(const char* missao) {
-    printf("  Missao: %s\n", missao);
-}
-
-/* Simples verificação de missão para o jogador cuja cor está em jogadorAtualCor.
-   As missões são frases fixas e a função detecta qual condição aplicar. */
-int verificarMissao(char* missao, Territorio* mapa, int tamanho) {
-    int i, count;
-    /* 1) Conquistar 3 territorios seguidos */
-    if (strstr(missao, "Conquistar 3 territorios seguidos") != NULL) {
-        int consec = 0;
-        for (i = 0; i < tamanho; ++i) {
-            if (strcmp(mapa[i].cor, jogadorAtualCor) == 0) {
-                consec++;
-                if (consec >= 3) return 1;
-            } else consec = 0;
-        }
-        return 0;
-    }
-
-    /* 2) Controlar 5 territorios */
-    if (strstr(missao, "Controlar 5 territorios") != NULL) {
-        count = 0;
-        for (i = 0; i < tamanho; ++i)
-            if (strcmp(mapa[i].cor, jogadorAtualCor) == 0) count++;
-        return (count >= 5) ? 1 : 0;
-    }
-
-    /* 3) Eliminar todas as tropas da cor vermelho/azul */
-    if (strstr(missao, "Eliminar todas as tropas da cor") != NULL) {
-        /* extrair cor alvo da string (última palavra) */
-        char copia[80];
-        strcpy(copia, missao);
-        char* token = strrchr(copia, ' ');
-        if (token) {
-            char corAlvo[10];
-            strcpy(corAlvo, token + 1); /* cor alvo */
-            /* somar tropas da cor alvo */
-            int soma = 0;
-            for (i = 0; i < tamanho; ++i)
-                if (strcmp(mapa[i].cor, corAlvo) == 0) soma += mapa[i].tropas;
-            return (soma == 0) ? 1 : 0;
-        }
-        return 0;
-    }
-
-    /* 4) Ter ao menos 10 tropas no total (somar tropas de sua cor) */
-    if (strstr(missao, "Ter ao menos 10 tropas no total") != NULL) {
-        int soma = 0;
-        for (i = 0; i < tamanho; ++i)
-            if (strcmp(mapa[i].cor, jogadorAtualCor) == 0) soma += mapa[i].tropas;
-        return (soma >= 10) ? 1 : 0;
-    }
-
-    /* 5) Controlar 8 territorios (exemplo) */
-    if (strstr(missao, "Controlar 8 territorios") != NULL) {
-        count = 0;
-        for (i = 0; i < tamanho; ++i)
-            if (strcmp(mapa[i].cor, jogadorAtualCor) == 0) count++;
-        return (count >= 8) ? 1 : 0;
-    }
-
-    /* se missão desconhecida, retorna 0 (não cumprida) */
-    return 0;
-}
-
-/* Função de ataque:
-   - valida que cores são diferentes antes de atacar
-   - rolagens rand() entre 1 e 6
-   - se atacante vence: defensor muda de cor e recebe metade das tropas do atacante
-   - se atacante perde: atacante perde 1 tropa (se possível)
-*/
-void atacar(Territorio* atacante, Territorio* defensor) {
-    if (!atacante || !defensor) return;
-    if (strcmp(atacante->cor, defensor->cor) == 0) {
-        printf("  Ataque inválido: mesmo dono.\n");
-        return;
-    }
-    if (atacante->tropas <= 0) {
-        printf("  Ataque inválido: atacante sem tropas.\n");
-        return;
-    }
-
-    int atRoll = (rand() % 6) + 1;
-    int defRoll = (rand() % 6) + 1;
-    printf("  %s (%s, tropas=%d) rola %d vs %s (%s, tropas=%d) rola %d\n",
-           atacante->nome, atacante->cor, atacante->tropas, atRoll,
-           defensor->nome, defensor->cor, defensor->tropas, defRoll);
-
-    if (atRoll > defRoll) {
-        /* atacante vence */
-        int transfer = atacante->tropas / 2;
-        if (transfer < 1) transfer = 1;
-        strcpy(defensor->cor, atacante->cor);
-        defensor->tropas = transfer;
-        atacante->tropas -= transfer;
-        if (atacante->tropas < 0) atacante->tropas = 0;
-        printf("  Ataque bem sucedido! %s agora pertence a %s com %d tropas (transferidas).\n",
-               defensor->nome, defensor->cor, defensor->tropas);
-    } else {
-        /* atacante perde 1 tropa */
-        if (atacante->tropas > 0) atacante->tropas -= 1;
-        printf("  Ataque falhou. %s perde 1 tropa (tropas agora: %d).\n",
-               atacante->nome, atacante->tropas);
-    }
-}
-
-/* Exibe mapa de forma simples */
-void exibirMapa(Territorio* mapa, int tamanho) {
-    int i;
-    printf("Mapa atual:\n");
-    for (i = 0; i < tamanho; ++i) {
-        printf("  %2d: %-10s | dono: %-8s | tropas: %2d\n",
-               i+1, mapa[i].nome, mapa[i].cor, mapa[i].tropas);
-    }
-}
-
-/* Libera memória alocada (territorios e as strings de missao de cada jogador) */
-void liberarMemoria(Territorio* mapa, char** missoesJogadores, int numPlayers) {
-    if (mapa) free(mapa);
-    if (missoesJogadores) {
-        for (int i = 0; i < numPlayers; ++i)
-            if (missoesJogadores[i]) free(missoesJogadores[i]);
-        free(missoesJogadores);
-    }
-}
-
-/* --- MAIN: inicializa, atribui missões, simula turnos e verifica missões --- */
-int main() {
-    srand((unsigned)time(NULL));
-
-    /* 1) vetor de missoes (pelo menos 5) */
-    char* missoesPadrao[MAX_MISSOES] = {
-        "Conquistar 3 territorios seguidos",
-        "Controlar 5 territorios",
-        "Eliminar todas as tropas da cor vermelho",
-        "Ter ao menos 10 tropas no total",
-        "Eliminar todas as tropas da cor azul",
-        "Controlar 8 territorios"
-    };
-
-    int totalMissoes = MAX_MISSOES;
-
-    /* 2) criar mapa dinamicamente */
-    Territorio* mapa = (Territorio*) calloc(MAX_TERR, sizeof(Territorio));
-    if (!mapa) {
-        perror("calloc mapa");
-        return 1;
-    }
-
-    /* inicializa alguns territorios com donos alternados e tropas aleatorias */
-    for (int i = 0; i < MAX_TERR; ++i) {
-        snprintf(mapa[i].nome, sizeof(mapa[i].nome), "Terr-%02d", i+1);
-        if (i % 2 == 0) strcpy(mapa[i].cor, "vermelho");
-        else strcpy(mapa[i].cor, "azul");
-        mapa[i].tropas = (rand() % 6) + 1; /* 1..6 tropas iniciais */
-    }
-
-    /* 3) jogadores e suas missões (armazenadas dinamicamente) */
-    const int numPlayers = 2;
-    char* coresJogadores[numPlayers];
-    coresJogadores[0] = "vermelho";
-    coresJogadores[1] = "azul";
-
-    /* aloca array de ponteiros para missões e cada missão recebe malloc */
-    char** missoesJogadores = (char**) malloc(numPlayers * sizeof(char*));
-    if (!missoesJogadores) {
-        perror("malloc missoesJogadores");
-        free(mapa);
-        return 1;
-    }
-
-    for (int p = 0; p < numPlayers; ++p) {
-        missoesJogadores[p] = (char*) malloc(100 * sizeof(char)); /* espaço suficiente */
-        if (!missoesJogadores[p]) {
-            perror("malloc missao");
-            /* liberar já alocado */
-            for (int k = 0; k < p; ++k) free(missoesJogadores[k]);
-            free(missoesJogadores);
-            free(mapa);
-            return 1;
-        }
-        atribuirMissao(missoesJogadores[p], missoesPadrao, totalMissoes);
-    }
-
-    /* exibe missões (apenas uma vez, conforme requisito) */
-    printf("Missões sorteadas (mostradas apenas uma vez):\n");
-    for (int p = 0; p < numPlayers; ++p) {
-        printf("Jogador %d (%s):\n", p+1, coresJogadores[p]);
-        exibirMissao(missoesJogadores[p]);
-    }
-    printf("\n");
-
-    /* exibe mapa inicial */
-    exibirMapa(mapa, MAX_TERR);
-    printf("\n");
-
-    /* 4) laço de jogo simplificado: alterna turnos, realiza 1 ataque por turno com escolhas aleatórias */
-    int vencedor = -1;
-    int maxTurnos = 200;
-    for (int turno = 1; turno <= maxTurnos && vencedor == -1; ++turno) {
-        printf("----- Turno %d -----\n", turno);
-        for (int p = 0; p < numPlayers && vencedor == -1; ++p) {
-            printf("> Vez do jogador %d (%s)\n", p+1, coresJogadores[p]);
-            /* escolhe um territorio atacante aleatorio do jogador que tenha tropas > 0 */
-            int attackerIdx = -1;
-            int defenderIdx = -1;
-            int attempts = 0;
-            while (attempts < 50) { /* tenta achar um atacante válido */
-                int idx = rand() % MAX_TERR;
-                if (strcmp(mapa[idx].cor, coresJogadores[p]) == 0 && mapa[idx].tropas > 0) {
-                    attackerIdx = idx;
-                    break;
-                }
-                attempts++;
-            }
-            /* escolhe defensor: territorio de inimigo */
-            attempts = 0;
-            while (attempts < 50) {
-                int idx = rand() % MAX_TERR;
-                if (strcmp(mapa[idx].cor, coresJogadores[p]) != 0) {
-                    defenderIdx = idx;
-                    break;
-                }
-                attempts++;
-            }
-
-            if (attackerIdx != -1 && defenderIdx != -1) {
-                printf("Jogador %s ataca: %s -> %s\n",
-                       coresJogadores[p], mapa[attackerIdx].nome, mapa[defenderIdx].nome);
-                atacar(&mapa[attackerIdx], &mapa[defenderIdx]);
-            } else {
-                printf("  Sem ataques possiveis neste turno.\n");
-            }
-
-            /* verificar missão do jogador silenciosamente ao fim do turno */
-            strcpy(jogadorAtualCor, coresJogadores[p]); /* informa qual jogador estamos testando */
-            if (verificarMissao(missoesJogadores[p], mapa, MAX_TERR)) {
-                vencedor = p;
-                printf("\n*** Jogador %d (%s) cumpriu a missao: %s ***\n",
-                       p+1, coresJogadores[p], missoesJogadores[p]);
-                break;
-            }
-        }
-
-        exibirMapa(mapa, MAX_TERR);
-        printf("\n");
-    }
-
-    if (vencedor == -1) {
-        printf("Fim do jogo: nenhum jogador cumpriu sua missao em %d turnos.\n", maxTurnos);
-    } else {
-        printf("Vencedor: Jogador %d (%s)\n", vencedor+1, coresJogadores[vencedor]);
-    }
-
-    /* liberar memoria */
-    liberarMemoria(mapa, missoesJogadores, numPlayers);
-
-    return 0;
-}
+
+/*
+  War estruturado: missões sorteadas, ataques com dados e verificação de missão por turno.
+  Compilar: gcc -o war war.c -std=c11 -pthread
+  Partida: ./war [semente] [--quieto|--resumo] [--registros]
+  Avaliação em lote de missões sobre muitos estados do mapa: ./war --bench-missoes [numEstados] [threads]
+*/
+
+#define _POSIX_C_SOURCE 200809L /* clock_gettime em -std=c11 */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "instr.h"
+#include "prng.h"
+#include "saida.h"
+
+#define MAX_TERR 10
+#define MAX_MISSOES 6
+#define LOTE_ESTADOS 4096 /* estados por tarefa da avaliação em lote (múltiplo de 64) */
+
+/* tipos de condição reconhecidos nas frases das missões */
+#define MISSAO_DESCONHECIDA 0
+#define MISSAO_SEGUIDOS 1   /* territórios consecutivos da cor do jogador */
+#define MISSAO_CONTROLAR 2  /* territórios da cor do jogador */
+#define MISSAO_ELIMINAR 3   /* nenhuma tropa na cor alvo */
+#define MISSAO_TROPAS 4     /* tropas somadas na cor do jogador */
+
+/* Estrutura de território */
+typedef struct {
+    char nome[30];
+    char cor[10];  /* dono: "vermelho", "azul", "neutro" */
+    int tropas;
+} Territorio;
+
+/* Missão já interpretada: a frase é lida uma vez e a avaliação só percorre o mapa */
+typedef struct {
+    int tipo;       /* MISSAO_* */
+    int limite;     /* quantidade exigida (territórios ou tropas) */
+    char corAlvo[10]; /* MISSAO_ELIMINAR */
+} MissaoCompilada;
+
+/* Tarefa da avaliação em lote: os blocos de LOTE_ESTADOS estados são distribuídos entre
+   as threads por um contador atômico; cada bloco ocupa palavras próprias do bitmap */
+typedef struct {
+    const Territorio *estados;
+    size_t numEstados;
+    int tamanho;
+    const MissaoCompilada *missoes;
+    int numMissoes;
+    const char *cor;
+    uint64_t *resultados;
+    _Atomic size_t *proximoBloco;
+    pthread_t thread;
+} TarefaMissoes;
+
+/* --- Prototipos --- */
+void atribuirMissao(char* destino, char* missoes[], int totalMissoes);
+int verificarMissao(char* missao, Territorio* mapa, int tamanho);
+void compilarMissao(const char* missao, MissaoCompilada* m);
+int avaliarMissao(const MissaoCompilada* m, const char* cor, const Territorio* mapa, int tamanho);
+int verificarMissaoDe(const char* missao, const char* cor, const Territorio* mapa, int tamanho);
+void avaliarMissoesEmLote(const Territorio* estados, size_t numEstados, int tamanho, char* missoes[],
+                          int numMissoes, const char* cor, uint64_t* resultados, int numThreads);
+void benchmarkMissoes(size_t numEstados, int maxThreads);
+void exibirMissao(const char* missao); /* passagem por valor (pointer passado por valor) */
+void atacar(Territorio* atacante, Territorio* defensor);
+void exibirMapa(Territorio* mapa, int tamanho);
+void liberarMemoria(Territorio* mapa, char** missoesJogadores, int numPlayers);
+
+/* Variável global que informa a cor do jogador atual para a função verificarMissao
+   (seguindo a assinatura pedida verificarMissao(char*, Territorio*, int)). */
+char jogadorAtualCor[10];
+
+/* Gerador da partida (sorteio de missões, tropas iniciais, escolhas e dados); a semente
+   pode ser passada na linha de comando para repetir uma partida */
+Prng aleatorio;
+
+/* --- Implementações --- */
+
+/* Escolhe aleatoriamente uma missão do vetor e copia para destino (destino deve estar alocado) */
+void atribuirMissao(char* destino, char* missoes[], int totalMissoes) {
+    int idx = (int) prngIntervalo(&aleatorio, (uint32_t) totalMissoes);
+    strcpy(destino, missoes[idx]); /* cópia conforme requisitado */
+}
+
+/* Exibe a missão (passagem por valor no sentido de não modificar) */
+void exibirMissao(const char* missao) {
+    saidaStr("  Missao: ");
+    saidaStr(missao);
+    saidaCar('\n');
+}
+
+/* Interpreta a frase da missão (as missões são frases fixas; a condição é detectada
+   pelo texto). Frases desconhecidas viram MISSAO_DESCONHECIDA, nunca cumprida. */
+void compilarMissao(const char* missao, MissaoCompilada* m) {
+    m->tipo = MISSAO_DESCONHECIDA;
+    m->limite = 0;
+    m->corAlvo[0] = '\0';
+    if (strstr(missao, "Conquistar 3 territorios seguidos") != NULL) {
+        m->tipo = MISSAO_SEGUIDOS;
+        m->limite = 3;
+    } else if (strstr(missao, "Controlar 5 territorios") != NULL) {
+        m->tipo = MISSAO_CONTROLAR;
+        m->limite = 5;
+    } else if (strstr(missao, "Eliminar todas as tropas da cor") != NULL) {
+        /* cor alvo: última palavra da frase */
+        const char* token = strrchr(missao, ' ');
+        if (token) {
+            m->tipo = MISSAO_ELIMINAR;
+            snprintf(m->corAlvo, sizeof(m->corAlvo), "%s", token + 1);
+        }
+    } else if (strstr(missao, "Ter ao menos 10 tropas no total") != NULL) {
+        m->tipo = MISSAO_TROPAS;
+        m->limite = 10;
+    } else if (strstr(missao, "Controlar 8 territorios") != NULL) {
+        m->tipo = MISSAO_CONTROLAR;
+        m->limite = 8;
+    }
+}
+
+/* Avalia a missão para o jogador da cor dada; só lê os argumentos, então pode ser
+   chamada de várias threads ao mesmo tempo */
+int avaliarMissao(const MissaoCompilada* m, const char* cor, const Territorio* mapa, int tamanho) {
+    int i, count = 0;
+    switch (m->tipo) {
+        case MISSAO_SEGUIDOS:
+            for (i = 0; i < tamanho; ++i) {
+                if (strcmp(mapa[i].cor, cor) == 0) {
+                    if (++count >= m->limite) return 1;
+                } else count = 0;
+            }
+            return 0;
+        case MISSAO_CONTROLAR:
+            for (i = 0; i < tamanho; ++i)
+                if (strcmp(mapa[i].cor, cor) == 0) count++;
+            return count >= m->limite;
+        case MISSAO_ELIMINAR:
+            for (i = 0; i < tamanho; ++i)
+                if (strcmp(mapa[i].cor, m->corAlvo) == 0) count += mapa[i].tropas;
+            return count == 0;
+        case MISSAO_TROPAS:
+            for (i = 0; i < tamanho; ++i)
+                if (strcmp(mapa[i].cor, cor) == 0) count += mapa[i].tropas;
+            return count >= m->limite;
+        default:
+            return 0; /* missão desconhecida: não cumprida */
+    }
+}
+
+/* Verificação re-entrante: a cor do jogador vem por parâmetro */
+int verificarMissaoDe(const char* missao, const char* cor, const Territorio* mapa, int tamanho) {
+    MissaoCompilada m;
+    compilarMissao(missao, &m);
+    return avaliarMissao(&m, cor, mapa, tamanho);
+}
+
+/* Verificação de missão para o jogador cuja cor está em jogadorAtualCor (assinatura
+   pedida; código novo, sobretudo com threads, deve usar verificarMissaoDe) */
+int verificarMissao(char* missao, Territorio* mapa, int tamanho) {
+    INSTR_CONTAR("war.verificarMissao");
+    return verificarMissaoDe(missao, jogadorAtualCor, mapa, tamanho);
+}
+
+/* Corpo de uma thread da avaliação em lote */
+static void* trabalharMissoes(void* arg) {
+    TarefaMissoes* t = (TarefaMissoes*) arg;
+    size_t numBlocos = (t->numEstados + LOTE_ESTADOS - 1) / LOTE_ESTADOS;
+    for (;;) {
+        size_t b = atomic_fetch_add(t->proximoBloco, 1);
+        if (b >= numBlocos) break;
+        size_t fim = (b + 1) * LOTE_ESTADOS;
+        if (fim > t->numEstados) fim = t->numEstados;
+        for (size_t e = b * LOTE_ESTADOS; e < fim; ++e) {
+            const Territorio* mapa = t->estados + e * (size_t) t->tamanho;
+            for (int m = 0; m < t->numMissoes; ++m) {
+                if (avaliarMissao(&t->missoes[m], t->cor, mapa, t->tamanho)) {
+                    size_t bit = e * (size_t) t->numMissoes + (size_t) m;
+                    t->resultados[bit / 64] |= 1ull << (bit % 64);
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Avalia todas as missões contra numEstados mapas de tamanho territórios guardados em
+   sequência em estados, para o jogador da cor dada. O bit estado * numMissoes + missao de
+   resultados (palavras de 64 bits, zeradas aqui) indica missão cumprida. Como LOTE_ESTADOS
+   é múltiplo de 64, blocos diferentes nunca escrevem na mesma palavra. */
+void avaliarMissoesEmLote(const Territorio* estados, size_t numEstados, int tamanho, char* missoes[],
+                          int numMissoes, const char* cor, uint64_t* resultados, int numThreads) {
+    memset(resultados, 0, (numEstados * (size_t) numMissoes + 63) / 64 * sizeof(uint64_t));
+    if (numEstados == 0 || numMissoes == 0) return;
+    MissaoCompilada* compiladas = (MissaoCompilada*) malloc(numMissoes * sizeof(MissaoCompilada));
+    if (numThreads < 1) numThreads = 1;
+    TarefaMissoes* tarefas = (TarefaMissoes*) malloc(numThreads * sizeof(TarefaMissoes));
+    if (!compiladas || !tarefas) {
+        perror("malloc avaliarMissoesEmLote");
+        exit(1);
+    }
+    for (int m = 0; m < numMissoes; ++m) compilarMissao(missoes[m], &compiladas[m]);
+
+    _Atomic size_t proximoBloco = 0;
+    for (int i = 0; i < numThreads; ++i) {
+        /* thread fica de fora: só pthread_create a preenche */
+        tarefas[i] = (TarefaMissoes) { .estados = estados, .numEstados = numEstados, .tamanho = tamanho,
+                                       .missoes = compiladas, .numMissoes = numMissoes, .cor = cor,
+                                       .resultados = resultados, .proximoBloco = &proximoBloco };
+        if (i > 0 && pthread_create(&tarefas[i].thread, NULL, trabalharMissoes, &tarefas[i]) != 0) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+    trabalharMissoes(&tarefas[0]); /* a thread chamadora também trabalha */
+    for (int i = 1; i < numThreads; ++i) pthread_join(tarefas[i].thread, NULL);
+    free(tarefas);
+    free(compiladas);
+}
+
+/* Função de ataque:
+   - valida que cores são diferentes antes de atacar
+   - rolagens entre 1 e 6 (sem viés, gerador da partida)
+   - se atacante vence: defensor muda de cor e recebe metade das tropas do atacante
+   - se atacante perde: atacante perde 1 tropa (se possível)
+   - relato em texto no nível normal, ou um registro "ataque" com --registros
+*/
+void atacar(Territorio* atacante, Territorio* defensor) {
+    if (!atacante || !defensor) return;
+    if (strcmp(atacante->cor, defensor->cor) == 0) {
+        if (saidaTexto(SAIDA_NORMAL)) saidaStr("  Ataque inválido: mesmo dono.\n");
+        return;
+    }
+    if (atacante->tropas <= 0) {
+        if (saidaTexto(SAIDA_NORMAL)) saidaStr("  Ataque inválido: atacante sem tropas.\n");
+        return;
+    }
+
+    INSTR_CONTAR("war.atacar");
+    int atRoll = prngEntre(&aleatorio, 1, 6);
+    int defRoll = prngEntre(&aleatorio, 1, 6);
+    int texto = saidaTexto(SAIDA_NORMAL);
+    if (texto) {
+        saidaStr("  ");
+        saidaStr(atacante->nome);
+        saidaStr(" (");
+        saidaStr(atacante->cor);
+        saidaStr(", tropas=");
+        saidaInt(atacante->tropas);
+        saidaStr(") rola ");
+        saidaInt(atRoll);
+        saidaStr(" vs ");
+        saidaStr(defensor->nome);
+        saidaStr(" (");
+        saidaStr(defensor->cor);
+        saidaStr(", tropas=");
+        saidaInt(defensor->tropas);
+        saidaStr(") rola ");
+        saidaInt(defRoll);
+        saidaCar('\n');
+    } else if (saidaRegistros(SAIDA_NORMAL)) {
+        saidaRegistro("ataque");
+        saidaCampoStr("atacante", atacante->nome);
+        saidaCampoStr("defensor", defensor->nome);
+        saidaCampoInt("dadoAtaque", atRoll);
+        saidaCampoInt("dadoDefesa", defRoll);
+        saidaCampoInt("venceu", atRoll > defRoll);
+        saidaFimRegistro();
+    }
+
+    if (atRoll > defRoll) {
+        /* atacante vence */
+        INSTR_CONTAR("war.atacar.vitorias");
+        int transfer = atacante->tropas / 2;
+        if (transfer < 1) transfer = 1;
+        strcpy(defensor->cor, atacante->cor);
+        defensor->tropas = transfer;
+        atacante->tropas -= transfer;
+        if (atacante->tropas < 0) atacante->tropas = 0;
+        if (texto) {
+            saidaStr("  Ataque bem sucedido! ");
+            saidaStr(defensor->nome);
+            saidaStr(" agora pertence a ");
+            saidaStr(defensor->cor);
+            saidaStr(" com ");
+            saidaInt(defensor->tropas);
+            saidaStr(" tropas (transferidas).\n");
+        }
+    } else {
+        /* atacante perde 1 tropa */
+        if (atacante->tropas > 0) atacante->tropas -= 1;
+        if (texto) {
+            saidaStr("  Ataque falhou. ");
+            saidaStr(atacante->nome);
+            saidaStr(" perde 1 tropa (tropas agora: ");
+            saidaInt(atacante->tropas);
+            saidaStr(").\n");
+        }
+    }
+}
+
+/* Exibe mapa de forma simples */
+void exibirMapa(Territorio* mapa, int tamanho) {
+    int i;
+    saidaStr("Mapa atual:\n");
+    for (i = 0; i < tamanho; ++i) {
+        saidaStr("  ");
+        saidaIntLargura(i + 1, 2);
+        saidaStr(": ");
+        saidaStrLargura(mapa[i].nome, 10);
+        saidaStr(" | dono: ");
+        saidaStrLargura(mapa[i].cor, 8);
+        saidaStr(" | tropas: ");
+        saidaIntLargura(mapa[i].tropas, 2);
+        saidaCar('\n');
+    }
+}
+
+/* Libera memória alocada (territorios e as strings de missao de cada jogador) */
+void liberarMemoria(Territorio* mapa, char** missoesJogadores, int numPlayers) {
+    if (mapa) free(mapa);
+    if (missoesJogadores) {
+        for (int i = 0; i < numPlayers; ++i)
+            if (missoesJogadores[i]) free(missoesJogadores[i]);
+        free(missoesJogadores);
+    }
+}
+
+static double relogioParede(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Número de bits 1 de x (soma em paralelo, sem builtins) */
+static int contarBits(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int) ((x * 0x0101010101010101ull) >> 56);
+}
+
+/* Sorteia numEstados mapas e compara, para cada jogador, a verificação uma a uma pela
+   global jogadorAtualCor com a avaliação em lote de 1 a maxThreads threads (mesmo bitmap) */
+void benchmarkMissoes(size_t numEstados, int maxThreads) {
+    char* missoes[MAX_MISSOES] = {
+        "Conquistar 3 territorios seguidos",
+        "Controlar 5 territorios",
+        "Eliminar todas as tropas da cor vermelho",
+        "Ter ao menos 10 tropas no total",
+        "Eliminar todas as tropas da cor azul",
+        "Controlar 8 territorios"
+    };
+    const char* cores[3] = { "vermelho", "azul", "neutro" };
+    if (numEstados < 1) numEstados = 1;
+    if (maxThreads < 1) maxThreads = 1;
+    size_t palavras = (numEstados * MAX_MISSOES + 63) / 64;
+    Territorio* estados = (Territorio*) malloc(numEstados * MAX_TERR * sizeof(Territorio));
+    uint64_t* referencia = (uint64_t*) calloc(palavras, sizeof(uint64_t));
+    uint64_t* resultados = (uint64_t*) malloc(palavras * sizeof(uint64_t));
+    if (!estados || !referencia || !resultados) {
+        perror("malloc benchmarkMissoes");
+        exit(1);
+    }
+    for (size_t e = 0; e < numEstados; ++e) {
+        for (int i = 0; i < MAX_TERR; ++i) {
+            Territorio* t = &estados[e * MAX_TERR + i];
+            snprintf(t->nome, sizeof(t->nome), "Terr-%02d", i+1);
+            strcpy(t->cor, cores[prngIntervalo(&aleatorio, 3)]);
+            t->tropas = prngEntre(&aleatorio, 0, 6);
+        }
+    }
+
+    printf("Avaliacao de %d missoes em %zu estados (%d territorios)\n", MAX_MISSOES, numEstados, MAX_TERR);
+    printf("%-9s | %-24s | %14s | %10s\n", "Jogador", "Modo", "estados/s", "cumpridas");
+    for (int j = 0; j < 2; ++j) {
+        memset(referencia, 0, palavras * sizeof(uint64_t));
+        double inicio = relogioParede();
+        strcpy(jogadorAtualCor, cores[j]);
+        for (size_t e = 0; e < numEstados; ++e)
+            for (int m = 0; m < MAX_MISSOES; ++m)
+                if (verificarMissao(missoes[m], &estados[e * MAX_TERR], MAX_TERR)) {
+                    size_t bit = e * MAX_MISSOES + (size_t) m;
+                    referencia[bit / 64] |= 1ull << (bit % 64);
+                }
+        double tempo = relogioParede() - inicio;
+        long cumpridas = 0;
+        for (size_t w = 0; w < palavras; ++w) cumpridas += contarBits(referencia[w]);
+        printf("%-9s | %-24s | %14.0f | %10ld\n", cores[j], "verificarMissao (global)",
+               tempo > 0 ? numEstados / tempo : 0.0, cumpridas);
+
+        for (int threads = 1; ; threads = threads * 2 < maxThreads ? threads * 2 : maxThreads) {
+            inicio = relogioParede();
+            avaliarMissoesEmLote(estados, numEstados, MAX_TERR, missoes, MAX_MISSOES, cores[j],
+                                 resultados, threads);
+            tempo = relogioParede() - inicio;
+            char modo[32];
+            snprintf(modo, sizeof(modo), "lote, %d thread(s)", threads);
+            int igual = memcmp(referencia, resultados, palavras * sizeof(uint64_t)) == 0;
+            printf("%-9s | %-24s | %14.0f | %10s\n", cores[j], modo,
+                   tempo > 0 ? numEstados / tempo : 0.0, igual ? "iguais" : "DIVERGENTE");
+            if (threads == maxThreads) break;
+        }
+    }
+    free(estados);
+    free(referencia);
+    free(resultados);
+}
+
+/* --- MAIN: inicializa, atribui missões, simula turnos e verifica missões --- */
+/* Semente decimal: só dígitos e cabendo em 64 bits; senão 0 (e *semente intacta) */
+static int lerSemente(const char* texto, uint64_t* semente) {
+    if (!*texto || strspn(texto, "0123456789") != strlen(texto)) return 0;
+    errno = 0;
+    unsigned long long valor = strtoull(texto, NULL, 10);
+    if (errno == ERANGE || valor > UINT64_MAX) return 0;
+    *semente = (uint64_t) valor;
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    /* ./war [semente] [--quieto|--resumo] [--registros]: sem semente, usa o relógio e a
+       semente usada é mostrada; --quieto só mostra o resultado, --resumo omite ataques e
+       mapas de cada turno e --registros troca o texto por uma linha JSON por evento */
+    uint64_t semente = prngSementeDoRelogio();
+    if (argc > 1 && strcmp(argv[1], "--bench-missoes") == 0) {
+        prngSemear(&aleatorio, semente);
+        benchmarkMissoes(argc > 2 ? strtoull(argv[2], NULL, 10) : 1000000, argc > 3 ? atoi(argv[3]) : 4);
+        return 0;
+    }
+    for (int i = 1; i < argc; ++i) {
+        if (saidaOpcao(argv[i])) continue;
+        if (!lerSemente(argv[i], &semente)) {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            fprintf(stderr, "Uso: %s [semente] [--quieto|--resumo] [--registros]\n", argv[0]);
+            return 1;
+        }
+    }
+    prngSemear(&aleatorio, semente);
+    saidaPreparar(0);
+    if (saidaTexto(SAIDA_RESUMO)) printf("Semente da partida: %llu\n\n", (unsigned long long) semente);
+    if (saidaRegistros(SAIDA_QUIETO)) {
+        char texto[24];
+        snprintf(texto, sizeof(texto), "%llu", (unsigned long long) semente); /* JSON perde 64 bits */
+        saidaRegistro("partida");
+        saidaCampoStr("semente", texto);
+        saidaFimRegistro();
+    }
+
+    /* 1) vetor de missoes (pelo menos 5) */
+    char* missoesPadrao[MAX_MISSOES] = {
+        "Conquistar 3 territorios seguidos",
+        "Controlar 5 territorios",
+        "Eliminar todas as tropas da cor vermelho",
+        "Ter ao menos 10 tropas no total",
+        "Eliminar todas as tropas da cor azul",
+        "Controlar 8 territorios"
+    };
+
+    int totalMissoes = MAX_MISSOES;
+
+    /* 2) criar mapa dinamicamente */
+    Territorio* mapa = (Territorio*) calloc(MAX_TERR, sizeof(Territorio));
+    if (!mapa) {
+        perror("calloc mapa");
+        return 1;
+    }
+
+    /* inicializa alguns territorios com donos alternados e tropas aleatorias */
+    for (int i = 0; i < MAX_TERR; ++i) {
+        snprintf(mapa[i].nome, sizeof(mapa[i].nome), "Terr-%02d", i+1);
+        if (i % 2 == 0) strcpy(mapa[i].cor, "vermelho");
+        else strcpy(mapa[i].cor, "azul");
+        mapa[i].tropas = prngEntre(&aleatorio, 1, 6); /* 1..6 tropas iniciais */
+    }
+
+    /* 3) jogadores e suas missões (armazenadas dinamicamente) */
+    const int numPlayers = 2;
+    char* coresJogadores[numPlayers];
+    coresJogadores[0] = "vermelho";
+    coresJogadores[1] = "azul";
+
+    /* aloca array de ponteiros para missões e cada missão recebe malloc */
+    char** missoesJogadores = (char**) malloc(numPlayers * sizeof(char*));
+    if (!missoesJogadores) {
+        perror("malloc missoesJogadores");
+        free(mapa);
+        return 1;
+    }
+
+    for (int p = 0; p < numPlayers; ++p) {
+        missoesJogadores[p] = (char*) malloc(100 * sizeof(char)); /* espaço suficiente */
+        if (!missoesJogadores[p]) {
+            perror("malloc missao");
+            /* liberar já alocado */
+            for (int k = 0; k < p; ++k) free(missoesJogadores[k]);
+            free(missoesJogadores);
+            free(mapa);
+            return 1;
+        }
+        atribuirMissao(missoesJogadores[p], missoesPadrao, totalMissoes);
+    }
+
+    /* exibe missões (apenas uma vez, conforme requisito) */
+    if (saidaTexto(SAIDA_RESUMO)) {
+        printf("Missões sorteadas (mostradas apenas uma vez):\n");
+        for (int p = 0; p < numPlayers; ++p) {
+            printf("Jogador %d (%s):\n", p+1, coresJogadores[p]);
+            exibirMissao(missoesJogadores[p]);
+        }
+        printf("\n");
+    }
+    for (int p = 0; p < numPlayers && saidaRegistros(SAIDA_RESUMO); ++p) {
+        saidaRegistro("missao");
+        saidaCampoInt("jogador", p + 1);
+        saidaCampoStr("cor", coresJogadores[p]);
+        saidaCampoStr("missao", missoesJogadores[p]);
+        saidaFimRegistro();
+    }
+
+    /* exibe mapa inicial */
+    if (saidaTexto(SAIDA_NORMAL)) {
+        exibirMapa(mapa, MAX_TERR);
+        printf("\n");
+    }
+
+    /* 4) laço de jogo simplificado: alterna turnos, realiza 1 ataque por turno com escolhas aleatórias */
+    int vencedor = -1;
+    int maxTurnos = 200;
+    for (int turno = 1; turno <= maxTurnos && vencedor == -1; ++turno) {
+        int texto = saidaTexto(SAIDA_NORMAL); /* relato do turno (ataques e mapa) */
+        if (texto) {
+            saidaStr("----- Turno ");
+            saidaInt(turno);
+            saidaStr(" -----\n");
+        }
+        for (int p = 0; p < numPlayers && vencedor == -1; ++p) {
+            if (texto) {
+                saidaStr("> Vez do jogador ");
+                saidaInt(p + 1);
+                saidaStr(" (");
+                saidaStr(coresJogadores[p]);
+                saidaStr(")\n");
+            }
+            /* escolhe um territorio atacante aleatorio do jogador que tenha tropas > 0 */
+            int attackerIdx = -1;
+            int defenderIdx = -1;
+            int attempts = 0;
+            while (attempts < 50) { /* tenta achar um atacante válido */
+                int idx = (int) prngIntervalo(&aleatorio, MAX_TERR);
+                if (strcmp(mapa[idx].cor, coresJogadores[p]) == 0 && mapa[idx].tropas > 0) {
+                    attackerIdx = idx;
+                    break;
+                }
+                attempts++;
+            }
+            /* escolhe defensor: territorio de inimigo */
+            attempts = 0;
+            while (attempts < 50) {
+                int idx = (int) prngIntervalo(&aleatorio, MAX_TERR);
+                if (strcmp(mapa[idx].cor, coresJogadores[p]) != 0) {
+                    defenderIdx = idx;
+                    break;
+                }
+                attempts++;
+            }
+
+            if (attackerIdx != -1 && defenderIdx != -1) {
+                if (texto) {
+                    saidaStr("Jogador ");
+                    saidaStr(coresJogadores[p]);
+                    saidaStr(" ataca: ");
+                    saidaStr(mapa[attackerIdx].nome);
+                    saidaStr(" -> ");
+                    saidaStr(mapa[defenderIdx].nome);
+                    saidaCar('\n');
+                }
+                atacar(&mapa[attackerIdx], &mapa[defenderIdx]); /* imprime: só contado (war.atacar) */
+            } else {
+                if (texto) saidaStr("  Sem ataques possiveis neste turno.\n");
+            }
+
+            /* verificar missão do jogador silenciosamente ao fim do turno */
+            INSTR_TEMPO_INICIO(tMissao, "war.verificarMissao.ns");
+            INSTR_CONTAR("war.verificarMissao");
+            int cumpriu = verificarMissaoDe(missoesJogadores[p], coresJogadores[p], mapa, MAX_TERR);
+            INSTR_TEMPO_FIM(tMissao);
+            if (cumpriu) {
+                vencedor = p;
+                if (saidaTexto(SAIDA_RESUMO))
+                    printf("\n*** Jogador %d (%s) cumpriu a missao: %s ***\n",
+                           p+1, coresJogadores[p], missoesJogadores[p]);
+                if (saidaRegistros(SAIDA_QUIETO)) {
+                    saidaRegistro("fim");
+                    saidaCampoInt("turno", turno);
+                    saidaCampoInt("vencedor", p + 1);
+                    saidaCampoStr("cor", coresJogadores[p]);
+                    saidaFimRegistro();
+                }
+                break;
+            }
+        }
+
+        if (texto) {
+            exibirMapa(mapa, MAX_TERR);
+            saidaCar('\n');
+        }
+    }
+
+    if (saidaRegistros(SAIDA_QUIETO)) {
+        if (vencedor == -1) {
+            saidaRegistro("fim");
+            saidaCampoInt("turno", maxTurnos);
+            saidaCampoInt("vencedor", 0);
+            saidaFimRegistro();
+        }
+    } else if (vencedor == -1) {
+        printf("Fim do jogo: nenhum jogador cumpriu sua missao em %d turnos.\n", maxTurnos);
+    } else {
+        printf("Vencedor: Jogador %d (%s)\n", vencedor+1, coresJogadores[vencedor]);
+    }
+
+    /* liberar memoria */
+    liberarMemoria(mapa, missoesJogadores, numPlayers);
+
+    return 0;
+}